@@ -18,6 +18,9 @@ GLSpace::GLSpace(QWidget *parent) :
   , m_is_draw_plane(true)
   , m_count_plane_line(200)
   , m_plane_width(500)
+  , m_plane_buffer(QGLBuffer::VertexBuffer)
+  , m_plane_changed(true)
+  , m_use_plane_buffer(true)
 {
 	ui->setupUi(this);
 
@@ -26,6 +29,8 @@ GLSpace::GLSpace(QWidget *parent) :
 
 	m_backround = QColor(0, 0, 0, 0);
 	m_translate.setZ(-2);
+
+	m_simulation.start_clock();
 }
 
 GLSpace::~GLSpace()
@@ -35,6 +40,7 @@ GLSpace::~GLSpace()
 	disconnect(&m_timer);
 
 	m_timer.stop();
+	m_simulation.stop_clock();
 
 	foreach (VirtGLObject* obj, m_objects) {
 		delete obj;
@@ -46,6 +52,7 @@ void GLSpace::add_object(VirtGLObject *obj)
 	if(!m_objects.contains(obj)){
 		obj->setParent(this);
 		m_objects.push_back(obj);
+		m_simulation.add_object(obj);
 	}
 }
 
@@ -100,7 +107,10 @@ void GLSpace::set_is_draw_plane(bool value)
 
 void GLSpace::set_count_lines_plane(int value)
 {
+	if(m_count_plane_line == value)
+		return;
 	m_count_plane_line = value;
+	m_plane_changed = true;
 }
 
 int GLSpace::count_lines_plane() const
@@ -110,7 +120,10 @@ int GLSpace::count_lines_plane() const
 
 void GLSpace::set_width_plane(double value)
 {
+	if(qFuzzyCompare(m_plane_width, value))
+		return;
 	m_plane_width = value;
+	m_plane_changed = true;
 }
 
 double GLSpace::width_plane() const
@@ -126,48 +139,78 @@ void GLSpace::calc_mouse_move(const QPointF &pos)
 	m_rotate += delta * 0.5;
 }
 
-void GLSpace::draw_plane()
+static inline void add_vertex(QVector< float >& vertices, double x, double y)
 {
-	glColor3f(1, 1, 1);
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(0);
+}
 
-	const int count = m_count_plane_line;
+void GLSpace::update_plane()
+{
+	const int count = qMax(0, m_count_plane_line);
 	const double width = m_plane_width;
 
-	glBegin(GL_LINES);
+	m_plane_vertices.clear();
+	m_plane_vertices.reserve((count * 4 + 4) * 3);
 
 	for(int i = 0; i < count; i++){
-		glVertex3d(-width/2.0,
-				   -width/2.0 + width * i/count,
-				   0);
-		glVertex3d(-width/2.0 + width,
-				   -width/2.0 + width * i/count,
-				   0);
+		add_vertex(m_plane_vertices, -width/2.0, -width/2.0 + width * i/count);
+		add_vertex(m_plane_vertices, -width/2.0 + width, -width/2.0 + width * i/count);
 	}
-	glEnd();
-
-	glBegin(GL_LINES);
 	for(int i = 0; i < count; i++){
-		glVertex3d(-width/2.0 + width* i/count,
-				   -width/2.0,
-				   0);
-		glVertex3d(-width/2.0 + width* i/count,
-				   -width/2.0 + width,
-				   0);
+		add_vertex(m_plane_vertices, -width/2.0 + width * i/count, -width/2.0);
+		add_vertex(m_plane_vertices, -width/2.0 + width * i/count, -width/2.0 + width);
 	}
 
-	glLineWidth(5);
+	/// axes
+	add_vertex(m_plane_vertices, -width, 0);
+	add_vertex(m_plane_vertices, width, 0);
+	add_vertex(m_plane_vertices, 0, -width);
+	add_vertex(m_plane_vertices, 0, width);
+
+	if(m_use_plane_buffer){
+		if(!m_plane_buffer.isCreated()){
+			m_plane_buffer.setUsagePattern(QGLBuffer::StaticDraw);
+			m_use_plane_buffer = m_plane_buffer.create();
+		}
+		if(m_use_plane_buffer){
+			m_plane_buffer.bind();
+			m_plane_buffer.allocate(m_plane_vertices.constData(), m_plane_vertices.size() * sizeof(float));
+			m_plane_buffer.release();
+		}
+	}
+
+	m_plane_changed = false;
+}
 
-	glBegin(GL_LINES);
-	glVertex3f(-width, 0, 0);
-	glVertex3f(width, 0, 0);
+void GLSpace::draw_plane()
+{
+	if(m_plane_changed)
+		update_plane();
+
+	/// 4 vertices of axes are at the end
+	const int count_axes = 4;
+	const int count_vertices = m_plane_vertices.size() / 3;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if(m_use_plane_buffer){
+		m_plane_buffer.bind();
+		glVertexPointer(3, GL_FLOAT, 0, 0);
+	}else{
+		glVertexPointer(3, GL_FLOAT, 0, m_plane_vertices.constData());
+	}
 
-	glVertex3f(0, -width, 0);
-	glVertex3f(0, width, 0);
-	glEnd();
+	glColor3f(1, 1, 1);
+	glDrawArrays(GL_LINES, 0, count_vertices - count_axes);
 
+	glLineWidth(5);
+	glDrawArrays(GL_LINES, count_vertices - count_axes, count_axes);
 	glLineWidth(1);
 
-	glEnd();
+	if(m_use_plane_buffer)
+		m_plane_buffer.release();
+	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 bool GLSpace::event(QEvent *ev)
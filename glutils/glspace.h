@@ -3,8 +3,10 @@
 
 #include <QWidget>
 #include <QGLWidget>
+#include <QGLBuffer>
 #include <QVector>
 #include "virtglobject.h"
+#include "simulationclock.h"
 #include <QVector3D>
 #include <QVector2D>
 #include <QPointF>
@@ -100,9 +102,15 @@ public:
 private:
 	Ui::GLSpace *ui;
 	QTimer m_timer;
+	SimulationClock m_simulation;
 	bool m_is_draw_plane;
 	int m_count_plane_line;
 	double m_plane_width;
+	/// lines of the plane and of the axes
+	QVector< float > m_plane_vertices;
+	QGLBuffer m_plane_buffer;
+	bool m_plane_changed;
+	bool m_use_plane_buffer;
 
 	QColor m_backround;
 	QVector< VirtGLObject* > m_objects;
@@ -113,6 +121,11 @@ private:
 	// QObject interface
 	void calc_mouse_move(const QPointF& pos);
 	void draw_plane();
+	/**
+	 * @brief update_plane
+	 * generate lines of the plane after change of count of lines or width
+	 */
+	void update_plane();
 public:
 	bool event(QEvent *);
 
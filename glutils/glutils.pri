@@ -1,8 +1,10 @@
 INCLUDEPATH += $$PWD
 
 SOURCES += $$PWD/glspace.cpp \
+			$$PWD/simulationclock.cpp \
 			$$PWD/spheregl.cpp
 HEADERS += $$PWD/glspace.h \
+			$$PWD/simulationclock.h \
 			$$PWD/spheregl.h \
 			$$PWD/virtglobject.h
 FORMS += $$PWD/glspace.ui
@@ -0,0 +1,79 @@
+#include "simulationclock.h"
+
+#include <QElapsedTimer>
+
+#include "virtglobject.h"
+
+SimulationClock::SimulationClock(QObject *parent)
+	: QThread(parent)
+	, m_stop(false)
+	, m_count_steps(0)
+{
+}
+
+SimulationClock::~SimulationClock()
+{
+	stop_clock();
+}
+
+void SimulationClock::add_object(VirtGLObject *obj)
+{
+	QMutexLocker lock(&m_mutex);
+	if(!m_objects.contains(obj))
+		m_objects.push_back(obj);
+}
+
+qint64 SimulationClock::count_steps() const
+{
+	return m_count_steps;
+}
+
+void SimulationClock::start_clock()
+{
+	if(isRunning())
+		return;
+	m_stop = false;
+	start(QThread::HighPriority);
+}
+
+void SimulationClock::stop_clock()
+{
+	m_stop = true;
+	wait();
+}
+
+void SimulationClock::run()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	const qint64 step_ns = step_ms * 1000000LL;
+	/// time of the next step, ns
+	qint64 next = 0;
+	while(!m_stop){
+		int count = 0;
+		qint64 now = timer.nsecsElapsed();
+		while(now >= next && count < max_steps && !m_stop){
+			step_objects(step_ms);
+			next += step_ns;
+			count++;
+			m_count_steps++;
+		}
+		if(now >= next){
+			/// steps do not keep up: the late time is dropped
+			next = now + step_ns;
+		}
+
+		qint64 wait_us = (next - timer.nsecsElapsed()) / 1000;
+		if(wait_us > 0)
+			usleep(wait_us);
+	}
+}
+
+void SimulationClock::step_objects(double dt)
+{
+	QMutexLocker lock(&m_mutex);
+	foreach (VirtGLObject* obj, m_objects) {
+		obj->step(dt);
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+
+class VirtGLObject;
+
+/**
+ * @brief The SimulationClock class
+ * own thread that advances objects by the fixed step of time with VirtGLObject::step.
+ * all due steps are done on each wakeup, so the simulation does not depend on the rate of frames.
+ * if steps do not keep up, the late time is dropped instead of the burst.
+ * the step is constant: models integrate once per step
+ */
+class SimulationClock : public QThread
+{
+public:
+	enum{
+		/// step of the simulation, ms
+		step_ms = 20,
+		/// maximum count of steps for one wakeup
+		max_steps = 10
+	};
+
+	explicit SimulationClock(QObject* parent = 0);
+	~SimulationClock();
+
+	void add_object(VirtGLObject* obj);
+	/**
+	 * @brief count_steps
+	 * @return count of steps from the start
+	 */
+	qint64 count_steps() const;
+
+	void start_clock();
+	/**
+	 * @brief stop_clock
+	 * stop the thread and wait for the current step
+	 */
+	void stop_clock();
+
+protected:
+	virtual void run();
+
+private:
+	QMutex m_mutex;
+	QVector< VirtGLObject* > m_objects;
+
+	std::atomic< bool > m_stop;
+	std::atomic< qint64 > m_count_steps;
+
+	void step_objects(double dt);
+};
+
+#endif // SIMULATIONCLOCK_H
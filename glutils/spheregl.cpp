@@ -57,8 +57,6 @@ void SphereGL::generate_sphere(double radius, double divider)
 			m_inds_sphere.push_back(Vector3i(A, B, C));
 		}
 	}
-
-    glVertexPointer(3, GL_FLOAT, sizeof(Vector3f), m_vecs_sphere.data()->data);
 }
 
 
@@ -77,6 +75,8 @@ void SphereGL::draw_sphere(const Vector3d &cp, double divider)
 	glColor3f(1, 1, 1);
 
 	int cnt = m_inds_sphere.size() * 3;
+	/// the pointer is set for each draw: other objects use own arrays
+	glVertexPointer(3, GL_FLOAT, sizeof(Vector3f), m_vecs_sphere.data()->data);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawElements(GL_LINE_STRIP, cnt, GL_UNSIGNED_INT, m_inds_sphere.data());
 	glDisableClientState(GL_VERTEX_ARRAY);
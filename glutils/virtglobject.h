@@ -32,9 +32,16 @@ public:
 	virtual void draw() = 0;
 	/**
 	 * @brief tick
-	 * for timer tick
+	 * for timer tick. called in the thread of gui before each frame
 	 */
 	virtual void tick() = 0;
+	/**
+	 * @brief step
+	 * fixed step of the simulation. called from the thread of SimulationClock,
+	 * so the state shared with draw() must be guarded
+	 * @param dt - step in ms
+	 */
+	virtual void step(double dt) { Q_UNUSED(dt); }
 	/**
 	 * @brief position
 	 * return object's position
@@ -0,0 +1,305 @@
+#include "blockwriter.h"
+
+#include <QFile>
+#include <QRunnable>
+
+#include <string.h>
+
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+////////////////////////////////////
+
+class BlockWriteRunnable: public QRunnable
+{
+public:
+	BlockWriteRunnable(BlockWriter* writer, int index)
+		: m_writer(writer)
+		, m_index(index)
+	{
+	}
+
+	virtual void run(){
+		m_writer->write_block(m_index);
+	}
+
+private:
+	BlockWriter *m_writer;
+	int m_index;
+};
+
+////////////////////////////////////
+
+BlockWriter::BlockWriter(int block_size)
+	: m_current(0)
+	, m_block_size(qMax((int)block_alignment, block_size))
+	, m_offset(0)
+	, m_backend(None)
+	, m_errors(0)
+	, m_fd(-1)
+	, m_file(0)
+{
+	/// one thread keeps the order of the writes simple
+	m_pool.setMaxThreadCount(1);
+
+	for(int i = 0; i < count_blocks; i++){
+		m_blocks[i].data = (char*)qMallocAligned(m_block_size, block_alignment);
+	}
+}
+
+BlockWriter::~BlockWriter()
+{
+	close();
+
+	for(int i = 0; i < count_blocks; i++){
+		qFreeAligned(m_blocks[i].data);
+	}
+}
+
+bool BlockWriter::open(const QString &fileName)
+{
+	close();
+
+	m_offset = 0;
+	m_current = 0;
+	m_errors = 0;
+	for(int i = 0; i < count_blocks; i++){
+		m_blocks[i].size = 0;
+	}
+
+#ifdef Q_OS_WIN
+	m_file = new QFile(fileName);
+	if(!m_file->open(QIODevice::WriteOnly)){
+		delete m_file;
+		m_file = 0;
+		return false;
+	}
+	m_backend = File;
+#else
+	m_fd = ::open(QFile::encodeName(fileName).constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(m_fd < 0)
+		return false;
+
+	m_backend = PWrite;
+#ifdef HAVE_LIBURING
+	if(io_uring_queue_init(count_blocks * 2, &m_ring, 0) == 0)
+		m_backend = IoUring;
+#endif
+#endif
+
+	return true;
+}
+
+bool BlockWriter::isOpen() const
+{
+	return m_backend != None;
+}
+
+void BlockWriter::write(const char *data, int size)
+{
+	if(!isOpen())
+		return;
+
+	while(size > 0){
+		Block& block = m_blocks[m_current];
+		int len = qMin(size, m_block_size - block.size);
+		memcpy(block.data + block.size, data, len);
+		block.size += len;
+		data += len;
+		size -= len;
+
+		if(block.size == m_block_size)
+			submit();
+	}
+}
+
+void BlockWriter::write(const QByteArray &data)
+{
+	write(data.constData(), data.size());
+}
+
+void BlockWriter::flush()
+{
+	if(!isOpen() || !m_blocks[m_current].size)
+		return;
+	submit();
+}
+
+void BlockWriter::close()
+{
+	if(!isOpen())
+		return;
+
+	flush();
+	for(int i = 0; i < count_blocks; i++){
+		wait_block(i);
+	}
+	m_pool.waitForDone();
+
+#ifdef HAVE_LIBURING
+	if(m_backend == IoUring)
+		io_uring_queue_exit(&m_ring);
+#endif
+
+	if(m_file){
+		m_file->close();
+		delete m_file;
+		m_file = 0;
+	}
+#ifndef Q_OS_WIN
+	if(m_fd >= 0){
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+	m_backend = None;
+}
+
+BlockWriter::Backend BlockWriter::backend() const
+{
+	return m_backend;
+}
+
+qint64 BlockWriter::size() const
+{
+	return m_offset + m_blocks[m_current].size;
+}
+
+int BlockWriter::errors() const
+{
+	return m_errors;
+}
+
+void BlockWriter::submit()
+{
+	int index = m_current;
+	Block& block = m_blocks[index];
+
+	block.offset = m_offset;
+	m_offset += block.size;
+	block.busy = true;
+
+	switch (m_backend) {
+#ifdef HAVE_LIBURING
+		case IoUring:
+			{
+				io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+				if(!sqe){
+					reap(true);
+					sqe = io_uring_get_sqe(&m_ring);
+				}
+				if(sqe){
+					io_uring_prep_write(sqe, m_fd, block.data, block.size, block.offset);
+					io_uring_sqe_set_data(sqe, (void*)(quintptr)index);
+					io_uring_submit(&m_ring);
+				}else{
+					/// no free entry in the ring: write synchronously
+					write_block(index);
+				}
+			}
+			break;
+#endif
+		default:
+			m_pool.start(new BlockWriteRunnable(this, index));
+			break;
+	}
+
+	m_current = (m_current + 1) % count_blocks;
+	wait_block(m_current);
+	m_blocks[m_current].size = 0;
+}
+
+void BlockWriter::wait_block(int index)
+{
+	Block& block = m_blocks[index];
+
+#ifdef HAVE_LIBURING
+	if(m_backend == IoUring){
+		while(block.busy){
+			reap(true);
+		}
+		return;
+	}
+#endif
+
+	QMutexLocker lock(&m_mutex);
+	while(block.busy){
+		m_cond_done.wait(&m_mutex);
+	}
+}
+
+void BlockWriter::block_done(int index, bool ok)
+{
+	if(!ok)
+		m_errors++;
+
+	QMutexLocker lock(&m_mutex);
+	m_blocks[index].busy = false;
+	m_cond_done.wakeAll();
+}
+
+void BlockWriter::write_block(int index)
+{
+	Block& block = m_blocks[index];
+	bool ok = true;
+
+#ifdef Q_OS_WIN
+	ok = m_file->seek(block.offset) && m_file->write(block.data, block.size) == block.size;
+#else
+	const char* data = block.data;
+	qint64 offset = block.offset;
+	int size = block.size;
+	while(size > 0){
+		ssize_t res = ::pwrite(m_fd, data, size, offset);
+		if(res < 0){
+			if(errno == EINTR)
+				continue;
+			ok = false;
+			break;
+		}
+		data += res;
+		offset += res;
+		size -= res;
+	}
+#endif
+
+	block_done(index, ok);
+}
+
+#ifdef HAVE_LIBURING
+
+void BlockWriter::reap(bool wait)
+{
+	io_uring_cqe *cqe = 0;
+	int res = wait? io_uring_wait_cqe(&m_ring, &cqe) : io_uring_peek_cqe(&m_ring, &cqe);
+	if(res == -EAGAIN || res == -EINTR)
+		return;
+	if(res < 0 || !cqe){
+		/// the ring failed: blocks in flight are lost
+		for(int i = 0; i < count_blocks; i++){
+			if(m_blocks[i].busy)
+				block_done(i, false);
+		}
+		return;
+	}
+
+	int index = (int)(quintptr)io_uring_cqe_get_data(cqe);
+	int written = cqe->res;
+	io_uring_cqe_seen(&m_ring, cqe);
+
+	Block& block = m_blocks[index];
+	if(written >= 0 && written < block.size){
+		/// short write: the rest synchronously
+		block.offset += written;
+		memmove(block.data, block.data + written, block.size - written);
+		block.size -= written;
+		write_block(index);
+		return;
+	}
+	block_done(index, written == block.size);
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef BLOCKWRITER_H
+#define BLOCKWRITER_H
+
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+
+#include <atomic>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+class QFile;
+
+////////////////////////////////////
+/// \brief The BlockWriter class
+/// writer of the file by large blocks in aligned memory.
+/// data is copied to the current block, the full block is submitted asynchronously
+/// and the next data goes to the second block. the caller waits only when both blocks are in flight.
+/// the partial block of flush moves the offset of the file to an unaligned position,
+/// so the alignment is of the memory only, offsets in the file are not aligned after the first flush
+/// backends: io_uring (HAVE_LIBURING), pwrite in the private thread, QFile in the private thread for win32
+class BlockWriter
+{
+public:
+	enum{ default_block_size = 1024 * 1024, block_alignment = 4096, count_blocks = 2 };
+
+	enum Backend{
+		None,
+		IoUring,
+		PWrite,
+		File
+	};
+
+	explicit BlockWriter(int block_size = default_block_size);
+	~BlockWriter();
+
+	bool open(const QString& fileName);
+	bool isOpen() const;
+	/**
+	 * @brief write
+	 * copy data to blocks. full blocks are submitted
+	 * @param data
+	 * @param size
+	 */
+	void write(const char* data, int size);
+	void write(const QByteArray& data);
+	/**
+	 * @brief flush
+	 * submit the current block even if it is not full. does not wait for the disk.
+	 * next blocks start at the unaligned offset of the file
+	 */
+	void flush();
+	/**
+	 * @brief close
+	 * submit the rest, wait for all blocks and close the file
+	 */
+	void close();
+
+	Backend backend() const;
+	/**
+	 * @brief size
+	 * @return count of bytes passed to write
+	 */
+	qint64 size() const;
+	/**
+	 * @brief errors
+	 * @return count of failed writes of blocks
+	 */
+	int errors() const;
+
+	/// write of the block in the private thread
+	void write_block(int index);
+
+private:
+	Q_DISABLE_COPY(BlockWriter)
+
+	struct Block{
+		Block(): data(0), size(0), offset(0), busy(false) {}
+
+		char* data;
+		int size;
+		qint64 offset;
+		std::atomic< bool > busy;
+	};
+
+	Block m_blocks[count_blocks];
+	int m_current;
+	int m_block_size;
+	qint64 m_offset;
+	Backend m_backend;
+	std::atomic< int > m_errors;
+
+	int m_fd;
+	QFile *m_file;
+	QThreadPool m_pool;
+	QMutex m_mutex;
+	QWaitCondition m_cond_done;
+
+#ifdef HAVE_LIBURING
+	io_uring m_ring;
+	/// reap completions of io_uring. wait for at least one if wait is set
+	void reap(bool wait);
+#endif
+
+	void submit();
+	void wait_block(int index);
+	void block_done(int index, bool ok);
+};
+
+#endif // BLOCKWRITER_H
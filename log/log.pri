@@ -1,4 +1,29 @@
 INCLUDEPATH += $$PWD
 
-SOURCES += $$PWD/writelog.cpp
-HEADERS += $$PWD/writelog.h
+SOURCES += $$PWD/writelog.cpp \
+			$$PWD/logindex.cpp \
+			$$PWD/blockwriter.cpp \
+			$$PWD/telemetryformat.cpp \
+			$$PWD/telemetrycompression.cpp
+HEADERS += $$PWD/writelog.h \
+			$$PWD/logindex.h \
+			$$PWD/blockwriter.h \
+			$$PWD/telemetryformat.h \
+			$$PWD/mpscqueue.h \
+			$$PWD/telemetrycompression.h
+
+unix:!macx{
+	CONFIG += link_pkgconfig
+	packagesExist(liburing){
+		PKGCONFIG += liburing
+		DEFINES += HAVE_LIBURING
+	}
+}
+
+unix{
+	CONFIG += link_pkgconfig
+	packagesExist(liblz4){
+		PKGCONFIG += liblz4
+		DEFINES += HAVE_LZ4
+	}
+}
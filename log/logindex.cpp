@@ -0,0 +1,153 @@
+#include "logindex.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+LogIndex::LogIndex()
+{
+}
+
+QString LogIndex::extension()
+{
+	return ".idx";
+}
+
+bool LogIndex::append(const QString &fileName, const LogIndexChunk &chunk)
+{
+	return write_entry(fileName, "chunk", chunk);
+}
+
+bool LogIndex::append_provisional(const QString &fileName, const LogIndexChunk &chunk)
+{
+	return write_entry(fileName, "open", chunk);
+}
+
+bool LogIndex::write_entry(const QString &fileName, const char *tag, const LogIndexChunk &chunk)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Append))
+		return false;
+
+	QTextStream stream(&file);
+	stream << tag << ";" << chunk.file << ";" << chunk.first_tick << ";" << chunk.last_tick << ";"
+		   << chunk.count << ";" << chunk.size << "\n";
+	foreach (const LogIndexPoint& point, chunk.points) {
+		stream << "point;" << point.tick << ";" << point.offset << "\n";
+	}
+	return true;
+}
+
+bool LogIndex::load(const QString &fileName)
+{
+	clear();
+
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	m_dir = QFileInfo(fileName).absolutePath();
+
+	while(!file.atEnd()){
+		QByteArray line = file.readLine().trimmed();
+		QList< QByteArray > sl = line.split(';');
+		if(sl.size() == 6 && (sl[0] == "chunk" || sl[0] == "open")){
+			LogIndexChunk chunk;
+			chunk.file = QString::fromUtf8(sl[1]);
+			chunk.first_tick = sl[2].toLongLong();
+			chunk.last_tick = sl[3].toLongLong();
+			chunk.count = sl[4].toLongLong();
+			chunk.size = sl[5].toLongLong();
+			chunk.provisional = sl[0] == "open";
+
+			if(!m_chunks.empty() && m_chunks.back().provisional && m_chunks.back().file == chunk.file){
+				/// the next provisional entry adds points, the closed file has all points
+				if(chunk.provisional)
+					chunk.points = m_chunks.back().points;
+				m_chunks.back() = chunk;
+			}else{
+				m_chunks.push_back(chunk);
+			}
+		}else if(sl.size() == 3 && sl[0] == "point" && !m_chunks.empty()){
+			m_chunks.back().points.push_back(LogIndexPoint(sl[1].toLongLong(), sl[2].toLongLong()));
+		}
+	}
+	return !m_chunks.empty();
+}
+
+void LogIndex::clear()
+{
+	m_chunks.clear();
+	m_dir.clear();
+}
+
+bool LogIndex::empty() const
+{
+	return m_chunks.empty();
+}
+
+const QVector<LogIndexChunk> &LogIndex::chunks() const
+{
+	return m_chunks;
+}
+
+QString LogIndex::chunk_path(int index) const
+{
+	if(index < 0 || index >= m_chunks.size())
+		return QString();
+	return m_dir + "/" + m_chunks[index].file;
+}
+
+qint64 LogIndex::first_tick() const
+{
+	return m_chunks.empty()? 0 : m_chunks.front().first_tick;
+}
+
+qint64 LogIndex::last_tick() const
+{
+	return m_chunks.empty()? 0 : m_chunks.back().last_tick;
+}
+
+qint64 LogIndex::count() const
+{
+	qint64 res = 0;
+	foreach (const LogIndexChunk& chunk, m_chunks) {
+		res += chunk.count;
+	}
+	return res;
+}
+
+bool LogIndex::find(qint64 tick, int &chunk, qint64 &offset) const
+{
+	if(m_chunks.empty())
+		return false;
+
+	/// the last chunk with first tick not greater than tick
+	int lo = 0, hi = m_chunks.size() - 1;
+	while(lo < hi){
+		int mid = (lo + hi + 1) / 2;
+		if(m_chunks[mid].first_tick <= tick)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	chunk = lo;
+
+	const QVector< LogIndexPoint >& points = m_chunks[lo].points;
+	if(points.empty()){
+		offset = -1;
+		return true;
+	}
+
+	lo = 0;
+	hi = points.size() - 1;
+	while(lo < hi){
+		int mid = (lo + hi + 1) / 2;
+		if(points[mid].tick <= tick)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	offset = points[lo].offset;
+	return true;
+}
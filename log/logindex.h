@@ -0,0 +1,103 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QString>
+#include <QVector>
+
+////////////////////////////////////
+/// \brief The LogIndexPoint struct
+/// sparse point of the index: tick of the device and byte offset of its record in the chunk
+struct LogIndexPoint{
+	LogIndexPoint(): tick(0), offset(0) {}
+	LogIndexPoint(qint64 tick, qint64 offset): tick(tick), offset(offset) {}
+
+	qint64 tick;
+	qint64 offset;
+};
+
+////////////////////////////////////
+/// \brief The LogIndexChunk struct
+/// one file of the session
+struct LogIndexChunk{
+	LogIndexChunk(): first_tick(0), last_tick(0), count(0), size(0), provisional(false) {}
+
+	/// name of the file without the path
+	QString file;
+	qint64 first_tick;
+	qint64 last_tick;
+	/// count of records with tick
+	qint64 count;
+	/// size of the file
+	qint64 size;
+	/// entry of the open file: written on the flush and replaced by the entry of the closed file
+	bool provisional;
+	QVector< LogIndexPoint > points;
+};
+
+////////////////////////////////////
+/// \brief The LogIndex class
+/// sidecar index of the session of the log.
+/// text file near chunks of the log, for each chunk the line
+/// "chunk;file;first_tick;last_tick;count;size" and then lines "point;tick;offset".
+/// the open file gets lines "open;file;first_tick;last_tick;count;size" with its new points on each flush,
+/// so the session keeps the file after the crash
+class LogIndex
+{
+public:
+	LogIndex();
+
+	/**
+	 * @brief extension
+	 * @return extension of the index file
+	 */
+	static QString extension();
+	/**
+	 * @brief append
+	 * append the chunk to the index file
+	 * @param fileName - index file
+	 * @param chunk
+	 * @return
+	 */
+	static bool append(const QString& fileName, const LogIndexChunk& chunk);
+	/**
+	 * @brief append_provisional
+	 * append the provisional entry of the open chunk
+	 * @param fileName - index file
+	 * @param chunk - counters of the chunk and points after the previous entry
+	 * @return
+	 */
+	static bool append_provisional(const QString& fileName, const LogIndexChunk& chunk);
+
+	bool load(const QString& fileName);
+	void clear();
+	bool empty() const;
+
+	const QVector< LogIndexChunk >& chunks() const;
+	/**
+	 * @brief chunk_path
+	 * full path of the file of the chunk
+	 * @param index
+	 * @return
+	 */
+	QString chunk_path(int index) const;
+	qint64 first_tick() const;
+	qint64 last_tick() const;
+	qint64 count() const;
+	/**
+	 * @brief find
+	 * the nearest point before the tick
+	 * @param tick
+	 * @param chunk - index of the chunk
+	 * @param offset - offset of the record in the chunk or -1 if chunk has no points
+	 * @return false if the index is empty
+	 */
+	bool find(qint64 tick, int& chunk, qint64& offset) const;
+
+private:
+	QString m_dir;
+	QVector< LogIndexChunk > m_chunks;
+
+	static bool write_entry(const QString& fileName, const char* tag, const LogIndexChunk& chunk);
+};
+
+#endif // LOGINDEX_H
@@ -0,0 +1,130 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+////////////////////////////////////
+/// \brief The MpscQueue class
+/// bounded lock-free queue for many producers and one consumer.
+/// each cell has a sequence number: a producer claims a position by CAS,
+/// fills the cell in place and publishes it by the sequence.
+/// producers never block: push returns false if the queue is full
+template< typename T >
+class MpscQueue
+{
+public:
+	/**
+	 * @brief MpscQueue
+	 * @param capacity - rounded up to a power of two
+	 */
+	explicit MpscQueue(size_t capacity = 1024)
+		: m_cells(0)
+		, m_mask(0)
+		, m_enqueue_pos(0)
+		, m_dequeue_pos(0)
+	{
+		size_t cap = 2;
+		while(cap < capacity)
+			cap <<= 1;
+
+		m_cells = new Cell[cap];
+		m_mask = cap - 1;
+		for(size_t i = 0; i < cap; i++){
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~MpscQueue()
+	{
+		delete[] m_cells;
+	}
+
+	size_t capacity() const { return m_mask + 1; }
+
+	/**
+	 * @brief push
+	 * @param fill - functor fill(T& cell) called for the claimed cell
+	 * @return false if the queue is full
+	 */
+	template< typename F >
+	bool push(F fill)
+	{
+		Cell* cell;
+		size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		for(;;){
+			cell = &m_cells[pos & m_mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+			if(dif == 0){
+				if(m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}else if(dif < 0){
+				return false;
+			}else{
+				pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		fill(cell->data);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief pop
+	 * only for one consumer thread
+	 * @param consume - functor consume(T& cell) called for each published cell in order
+	 * @param max_count - maximum count of cells for this call
+	 * @return count of consumed cells
+	 */
+	template< typename F >
+	size_t pop(F consume, size_t max_count)
+	{
+		size_t count = 0;
+		size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		while(count < max_count){
+			Cell* cell = &m_cells[pos & m_mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			if((std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1) < 0)
+				break;
+			consume(cell->data);
+			cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+			pos++;
+			count++;
+		}
+		m_dequeue_pos.store(pos, std::memory_order_relaxed);
+		return count;
+	}
+
+	/**
+	 * @brief size_approx
+	 * count of claimed cells. may include cells that are not published yet
+	 * @return
+	 */
+	size_t size_approx() const
+	{
+		size_t enq = m_enqueue_pos.load(std::memory_order_relaxed);
+		size_t deq = m_dequeue_pos.load(std::memory_order_relaxed);
+		return enq >= deq? enq - deq : 0;
+	}
+
+private:
+	MpscQueue(const MpscQueue&);
+	MpscQueue& operator= (const MpscQueue&);
+
+	struct Cell{
+		std::atomic< size_t > sequence;
+		T data;
+	};
+
+	enum{ cache_line = 64 };
+
+	Cell* m_cells;
+	size_t m_mask;
+	char m_pad0[cache_line];
+	std::atomic< size_t > m_enqueue_pos;
+	char m_pad1[cache_line];
+	std::atomic< size_t > m_dequeue_pos;
+};
+
+#endif // MPSCQUEUE_H
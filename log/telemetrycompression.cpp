@@ -0,0 +1,344 @@
+#include "telemetrycompression.h"
+
+#include <QtEndian>
+
+#include <string.h>
+#include <float.h>
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+const char TelemetryCompression::magic[4] = {'G', 'L', 'S', 'Z'};
+
+////////////////////////////////////
+
+static inline quint64 zigzag(qint64 val)
+{
+	return ((quint64)val << 1) ^ (quint64)(val >> 63);
+}
+
+static inline qint64 unzigzag(quint64 val)
+{
+	return (qint64)(val >> 1) ^ -(qint64)(val & 1);
+}
+
+static inline uchar* put_varint(uchar* dst, quint64 val)
+{
+	while(val >= 0x80){
+		*dst++ = (uchar)(val | 0x80);
+		val >>= 7;
+	}
+	*dst++ = (uchar)val;
+	return dst;
+}
+
+static inline const uchar* get_varint(const uchar* src, const uchar* end, quint64& val)
+{
+	val = 0;
+	for(int shift = 0; src < end && shift < 64; shift += 7){
+		uchar b = *src++;
+		val |= (quint64)(b & 0x7f) << shift;
+		if(!(b & 0x80))
+			return src;
+	}
+	return 0;
+}
+
+/**
+ * @brief fits_float
+ * the float keeps the value with the precision of the csv log
+ */
+static inline bool fits_float(double val)
+{
+	/// nan and values exact in float
+	if(val != val || (double)(float)val == val)
+		return true;
+	/// in the normal range the float keeps 7 significant digits, the csv log keeps 6
+	double a = qAbs(val);
+	return a >= FLT_MIN && a <= FLT_MAX;
+}
+
+static inline quint32 float_bits(double val)
+{
+	float f = (float)val;
+	quint32 res;
+	memcpy(&res, &f, sizeof(res));
+	return res;
+}
+
+static inline qint64 float_to_double_bits(quint32 bits)
+{
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	double d = f;
+	qint64 res;
+	memcpy(&res, &d, sizeof(res));
+	return res;
+}
+
+static inline double bits_to_double(qint64 bits)
+{
+	double res;
+	memcpy(&res, &bits, sizeof(res));
+	return res;
+}
+
+/// value of the column as integer. doubles as bits
+static inline qint64 get_column(const uchar* src, int size)
+{
+	if(size == 8)
+		return qFromLittleEndian< qint64 >(src);
+	return qFromLittleEndian< qint32 >(src);
+}
+
+static inline void put_column(uchar* dst, int size, qint64 val)
+{
+	if(size == 8)
+		qToLittleEndian< qint64 >(val, dst);
+	else
+		qToLittleEndian< qint32 >((qint32)val, dst);
+}
+
+////////////////////////////////////
+
+TelemetryCompression::Codec TelemetryCompression::default_codec()
+{
+#ifdef HAVE_LZ4
+	return LZ4;
+#else
+	return Zlib;
+#endif
+}
+
+bool TelemetryCompression::is_codec_supported(int codec)
+{
+#ifdef HAVE_LZ4
+	if(codec == LZ4)
+		return true;
+#endif
+	return codec == Zlib;
+}
+
+QByteArray TelemetryCompression::header(TelemetryCompression::Codec codec)
+{
+	QByteArray res;
+	res.append(magic, 4);
+
+	uchar buf[2];
+	qToLittleEndian< quint16 >(codec, buf);
+	res.append((const char*)buf, 2);
+	qToLittleEndian< quint16 >(coding_version, buf);
+	res.append((const char*)buf, 2);
+
+	res.append(TelemetryFormat::header());
+	return res;
+}
+
+int TelemetryCompression::read_header(const char *data, int size, TelemetrySchema &schema, int &codec)
+{
+	schema = TelemetrySchema();
+
+	if(size < 8 || memcmp(data, magic, 4) != 0)
+		return 0;
+
+	codec = qFromLittleEndian< quint16 >((const uchar*)data + 4);
+	if(qFromLittleEndian< quint16 >((const uchar*)data + 6) != coding_version)
+		codec = 0;
+
+	int res = TelemetryFormat::read_header(data + 8, size - 8, schema);
+	if(!res)
+		return 0;
+	return res + 8;
+}
+
+void TelemetryCompression::encode_block(const uchar *records, int count, TelemetryCompression::Codec codec, QByteArray &dst)
+{
+	if(count <= 0)
+		return;
+
+	const TelemetrySchema& schema = TelemetryFormat::current_schema();
+	const int columns = schema.column_types.size();
+
+	/// 10 bytes is the longest varint of 64 bits
+	QByteArray raw;
+	raw.resize(columns + count * columns * 10);
+	uchar* codings = (uchar*)raw.data();
+	uchar* out = codings + columns;
+
+	int offset = 0;
+	for(int c = 0; c < columns; c++){
+		int size = TelemetryFormat::type_size(schema.column_types[c]);
+		const uchar* src = records + offset;
+
+		ColumnCoding coding = DeltaInt;
+		if(schema.column_types[c] == TelemetryFormat::F64){
+			coding = XorFloat;
+			for(int i = 0; i < count && coding == XorFloat; i++){
+				if(!fits_float(bits_to_double(get_column(src + i * schema.record_size, size))))
+					coding = XorDouble;
+			}
+		}
+		codings[c] = coding;
+
+		quint64 prev = 0;
+		for(int i = 0; i < count; i++, src += schema.record_size){
+			qint64 val = get_column(src, size);
+			switch (coding) {
+				case XorFloat:
+					{
+						quint32 bits = float_bits(bits_to_double(val));
+						out = put_varint(out, bits ^ prev);
+						prev = bits;
+					}
+					break;
+				case XorDouble:
+					out = put_varint(out, (quint64)val ^ prev);
+					prev = val;
+					break;
+				default:
+					/// unsigned arithmetic: deltas may overflow
+					out = put_varint(out, zigzag((qint64)((quint64)val - prev)));
+					prev = val;
+					break;
+			}
+		}
+		offset += size;
+	}
+	raw.resize(out - (const uchar*)raw.constData());
+
+	QByteArray payload;
+	switch (codec) {
+#ifdef HAVE_LZ4
+		case LZ4:
+			{
+				payload.resize(LZ4_compressBound(raw.size()));
+				int res = LZ4_compress_default(raw.constData(), payload.data(), raw.size(), payload.size());
+				payload.resize(qMax(0, res));
+			}
+			break;
+#endif
+		case Zlib:
+		default:
+			payload = qCompress(raw, 1);
+			break;
+	}
+
+	qint64 first_tick = 0;
+	if(schema.offsets[TelemetryFormat::GYRO_TICK] >= 0)
+		first_tick = qFromLittleEndian< qint64 >(records + schema.offsets[TelemetryFormat::GYRO_TICK]);
+
+	uchar head[block_header_size];
+	qToLittleEndian< quint32 >(payload.size(), head);
+	qToLittleEndian< quint32 >(raw.size(), head + 4);
+	qToLittleEndian< quint32 >(count, head + 8);
+	qToLittleEndian< qint64 >(first_tick, head + 12);
+
+	dst.append((const char*)head, block_header_size);
+	dst.append(payload);
+}
+
+bool TelemetryCompression::read_block_header(const char *data, int size, TelemetryBlockHeader &header)
+{
+	if(size < block_header_size)
+		return false;
+
+	const uchar* ptr = (const uchar*)data;
+	header.size = qFromLittleEndian< quint32 >(ptr);
+	header.raw_size = qFromLittleEndian< quint32 >(ptr + 4);
+	header.count = qFromLittleEndian< quint32 >(ptr + 8);
+	header.first_tick = qFromLittleEndian< qint64 >(ptr + 12);
+	return header.size <= (quint32)max_block_size;
+}
+
+bool TelemetryCompression::decode_block(const char *payload, const TelemetryBlockHeader &header,
+										const TelemetrySchema &schema, int codec, QByteArray &dst)
+{
+	if(!schema.is_valid() || schema.column_types.isEmpty())
+		return false;
+
+	/// each value takes at least one byte and at most twice the size of the column,
+	/// the payload is not larger than the raw data with the overhead of the codec
+	const qint64 columns = schema.column_types.size();
+	if(!header.count || header.count > (quint32)default_block_records
+			|| header.raw_size > (qint64)header.count * schema.record_size * 2 + columns
+			|| header.raw_size < (header.count + 1) * columns
+			|| header.size > header.raw_size + header.raw_size / 255 + 64){
+		return false;
+	}
+
+	QByteArray raw;
+	switch (codec) {
+#ifdef HAVE_LZ4
+		case LZ4:
+			{
+				raw.resize(header.raw_size);
+				int res = LZ4_decompress_safe(payload, raw.data(), header.size, header.raw_size);
+				if(res != (int)header.raw_size)
+					return false;
+			}
+			break;
+#endif
+		case Zlib:
+			/// qUncompress allocates by the size in the first 4 bytes of the payload
+			if(header.size < 4 || qFromBigEndian< quint32 >((const uchar*)payload) != header.raw_size)
+				return false;
+			raw = qUncompress((const uchar*)payload, header.size);
+			if(raw.size() != (int)header.raw_size)
+				return false;
+			break;
+		default:
+			return false;
+	}
+
+	const int count = header.count;
+	const int pos = dst.size();
+	dst.resize(pos + count * schema.record_size);
+	uchar* records = (uchar*)dst.data() + pos;
+
+	const uchar* codings = (const uchar*)raw.constData();
+	const uchar* src = codings + columns;
+	const uchar* end = codings + raw.size();
+
+	int offset = 0;
+	for(int c = 0; c < schema.column_types.size(); c++){
+		int size = TelemetryFormat::type_size(schema.column_types[c]);
+		const int coding = codings[c];
+		if(coding > XorFloat || (coding != DeltaInt && size != 8)){
+			dst.resize(pos);
+			return false;
+		}
+
+		uchar* out = records + offset;
+		quint64 prev = 0;
+		for(int i = 0; i < count; i++, out += schema.record_size){
+			quint64 val;
+			src = get_varint(src, end, val);
+			if(!src || (coding == XorFloat && val > 0xffffffffull)){
+				dst.resize(pos);
+				return false;
+			}
+			switch (coding) {
+				case XorFloat:
+					prev ^= val;
+					put_column(out, size, float_to_double_bits((quint32)prev));
+					break;
+				case XorDouble:
+					prev ^= val;
+					put_column(out, size, (qint64)prev);
+					break;
+				default:
+					prev += (quint64)unzigzag(val);
+					put_column(out, size, (qint64)prev);
+					break;
+			}
+		}
+		offset += size;
+	}
+	/// the rest of the payload means the broken block
+	if(src != end){
+		dst.resize(pos);
+		return false;
+	}
+	return true;
+}
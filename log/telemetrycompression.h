@@ -0,0 +1,117 @@
+#ifndef TELEMETRYCOMPRESSION_H
+#define TELEMETRYCOMPRESSION_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "telemetryformat.h"
+
+////////////////////////////////////
+/// \brief The TelemetryBlockHeader struct
+/// header of the block of the compressed log
+struct TelemetryBlockHeader{
+	TelemetryBlockHeader(): size(0), raw_size(0), count(0), first_tick(0) {}
+
+	/// size of the compressed payload
+	quint32 size;
+	/// size of the payload after decompression
+	quint32 raw_size;
+	/// count of samples
+	quint32 count;
+	/// tick of the gyroscope of the first sample
+	qint64 first_tick;
+};
+
+////////////////////////////////////
+/// \brief The TelemetryCompression class
+/// compressed log of telemetry:
+/// header: magic "GLSZ", codec (u16), version of the coding (u16), header of the binary log;
+/// then blocks: size of the payload (u32), size of the raw payload (u32), count of samples (u32),
+/// first tick (i64), compressed payload.
+/// raw payload: the coding of each column (u8), then columns in order of the schema.
+/// integers are zigzag varints of deltas between samples of the block,
+/// doubles are varints of the xor of bits with the previous value (as in the Gorilla store).
+/// the column of doubles is stored by bits of float if all its values of the block are in the normal range of float:
+/// the float keeps 7 significant digits, more than the csv log
+class TelemetryCompression
+{
+public:
+	enum Codec{
+		Zlib = 1,
+		LZ4
+	};
+
+	/// coding of the column in the block
+	enum ColumnCoding{
+		DeltaInt = 0,
+		XorDouble,
+		XorFloat
+	};
+
+	enum{
+		/// version of the coding of columns in the header of the file
+		coding_version = 1,
+		block_header_size = 20,
+		default_block_records = 4096,
+		/// larger payloads are treated as the broken header
+		max_block_size = 16 * 1024 * 1024
+	};
+
+	static const char magic[4];
+
+	/**
+	 * @brief default_codec
+	 * LZ4 if it is available in the build
+	 * @return
+	 */
+	static Codec default_codec();
+	static bool is_codec_supported(int codec);
+	/**
+	 * @brief header
+	 * header of the file with the schema of the current version
+	 * @param codec
+	 * @return
+	 */
+	static QByteArray header(Codec codec);
+	/**
+	 * @brief read_header
+	 * @param data
+	 * @param size
+	 * @param schema - layout of records in blocks
+	 * @param codec - 0 if the version of the coding is not supported
+	 * @return size of the header or 0 if data is not a compressed log
+	 */
+	static int read_header(const char* data, int size, TelemetrySchema& schema, int& codec);
+	/**
+	 * @brief encode_block
+	 * append the block with records of the current schema to dst
+	 * @param records - binary records
+	 * @param count - count of records
+	 * @param codec
+	 * @param dst
+	 */
+	static void encode_block(const uchar* records, int count, Codec codec, QByteArray& dst);
+	/**
+	 * @brief read_block_header
+	 * @param data
+	 * @param size
+	 * @param header
+	 * @return false if data is too short or the size of the block is not sane
+	 */
+	static bool read_block_header(const char* data, int size, TelemetryBlockHeader& header);
+	/**
+	 * @brief decode_block
+	 * decode the payload of the block to records of the schema and append them to dst.
+	 * sizes of the header are checked before the allocation, so broken blocks are rejected
+	 * @param payload - compressed payload after the header of the block
+	 * @param header
+	 * @param schema
+	 * @param codec
+	 * @param dst - binary records
+	 * @return false if the block is broken
+	 */
+	static bool decode_block(const char* payload, const TelemetryBlockHeader& header,
+							 const TelemetrySchema& schema, int codec, QByteArray& dst);
+};
+
+#endif // TELEMETRYCOMPRESSION_H
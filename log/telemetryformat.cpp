@@ -0,0 +1,331 @@
+#include "telemetryformat.h"
+
+#include <QtEndian>
+
+#include <string.h>
+
+using namespace sc;
+using namespace vector3_;
+
+const char TelemetryFormat::magic[4] = {'G', 'L', 'S', 'B'};
+
+struct FieldDesc{
+	const char* name;
+	int type;
+};
+
+/// order of the fields is the same as in the csv log
+static const FieldDesc fields[TelemetryFormat::FIELD_COUNT] = {
+	{"bank",			TelemetryFormat::F64},
+	{"course",			TelemetryFormat::F64},
+	{"tangaj",			TelemetryFormat::F64},
+	{"height",			TelemetryFormat::F64},
+	{"gyro_temp",		TelemetryFormat::F64},
+	{"accel_x",			TelemetryFormat::I32},
+	{"accel_y",			TelemetryFormat::I32},
+	{"accel_z",			TelemetryFormat::I32},
+	{"gyro_x",			TelemetryFormat::I32},
+	{"gyro_y",			TelemetryFormat::I32},
+	{"gyro_z",			TelemetryFormat::I32},
+	{"afs_sel",			TelemetryFormat::I32},
+	{"fs_sel",			TelemetryFormat::I32},
+	{"freq",			TelemetryFormat::I32},
+	{"gyro_tick",		TelemetryFormat::I64},
+	{"compass_x",		TelemetryFormat::I32},
+	{"compass_y",		TelemetryFormat::I32},
+	{"compass_z",		TelemetryFormat::I32},
+	{"compass_tick",	TelemetryFormat::I64},
+	{"baro_data",		TelemetryFormat::I32},
+	{"baro_temp",		TelemetryFormat::I32},
+	{"baro_tick",		TelemetryFormat::I64},
+};
+
+int TelemetryFormat::type_size(int type)
+{
+	switch (type) {
+		case TelemetryFormat::F64:
+		case TelemetryFormat::I64:
+			return 8;
+		case TelemetryFormat::I32:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+////////////////////////////////////
+
+static inline void put_i32(uchar*& dst, qint32 val)
+{
+	qToLittleEndian< qint32 >(val, dst);
+	dst += 4;
+}
+
+static inline void put_i64(uchar*& dst, qint64 val)
+{
+	qToLittleEndian< qint64 >(val, dst);
+	dst += 8;
+}
+
+static inline void put_f64(uchar*& dst, double val)
+{
+	quint64 bits;
+	memcpy(&bits, &val, 8);
+	qToLittleEndian< quint64 >(bits, dst);
+	dst += 8;
+}
+
+static inline double get_value(const uchar* src, int offset, int type)
+{
+	if(offset < 0)
+		return 0;
+	src += offset;
+	switch (type) {
+		case TelemetryFormat::F64:
+			{
+				quint64 bits = qFromLittleEndian< quint64 >(src);
+				double val;
+				memcpy(&val, &bits, 8);
+				return val;
+			}
+		case TelemetryFormat::I32:
+			return qFromLittleEndian< qint32 >(src);
+		case TelemetryFormat::I64:
+			return qFromLittleEndian< qint64 >(src);
+		default:
+			return 0;
+	}
+}
+
+static inline qint64 get_int(const uchar* src, int offset, int type)
+{
+	if(offset < 0)
+		return 0;
+	if(type == TelemetryFormat::I64)
+		return qFromLittleEndian< qint64 >(src + offset);
+	return get_value(src, offset, type);
+}
+
+////////////////////////////////////
+
+TelemetrySchema::TelemetrySchema()
+	: offsets(TelemetryFormat::FIELD_COUNT, -1)
+	, types(TelemetryFormat::FIELD_COUNT, 0)
+	, record_size(0)
+{
+}
+
+////////////////////////////////////
+
+int TelemetryFormat::record_size()
+{
+	return current_schema().record_size;
+}
+
+const char *TelemetryFormat::field_name(int field)
+{
+	if(field < 0 || field >= FIELD_COUNT)
+		return "";
+	return fields[field].name;
+}
+
+int TelemetryFormat::field_type(int field)
+{
+	if(field < 0 || field >= FIELD_COUNT)
+		return 0;
+	return fields[field].type;
+}
+
+static TelemetrySchema make_schema()
+{
+	TelemetrySchema schema;
+	int offset = 0;
+	for(int i = 0; i < TelemetryFormat::FIELD_COUNT; i++){
+		schema.offsets[i] = offset;
+		schema.types[i] = fields[i].type;
+		schema.column_types.push_back(fields[i].type);
+		offset += TelemetryFormat::type_size(fields[i].type);
+	}
+	schema.record_size = offset;
+	return schema;
+}
+
+const TelemetrySchema &TelemetryFormat::current_schema()
+{
+	/// the initialization of the static is thread-safe, the schema is used by writers and pools
+	static const TelemetrySchema schema = make_schema();
+	return schema;
+}
+
+QByteArray TelemetryFormat::header()
+{
+	QByteArray res;
+	res.append(magic, 4);
+
+	uchar buf[2];
+	qToLittleEndian< quint16 >(version, buf);
+	res.append((const char*)buf, 2);
+	qToLittleEndian< quint16 >(FIELD_COUNT, buf);
+	res.append((const char*)buf, 2);
+
+	for(int i = 0; i < FIELD_COUNT; i++){
+		int len = strlen(fields[i].name);
+		res.append((char)fields[i].type);
+		res.append((char)len);
+		res.append(fields[i].name, len);
+	}
+	return res;
+}
+
+int TelemetryFormat::read_header(const char *data, int size, TelemetrySchema &schema)
+{
+	schema = TelemetrySchema();
+
+	if(size < 8 || memcmp(data, magic, 4) != 0)
+		return 0;
+
+	const uchar* ptr = (const uchar*)data;
+	quint16 ver = qFromLittleEndian< quint16 >(ptr + 4);
+	quint16 count = qFromLittleEndian< quint16 >(ptr + 6);
+	if(!ver)
+		return 0;
+
+	int pos = 8;
+	int offset = 0;
+	for(int i = 0; i < count; i++){
+		if(pos + 2 > size)
+			return 0;
+		int type = ptr[pos];
+		int len = ptr[pos + 1];
+		pos += 2;
+		if(pos + len > size || !type_size(type))
+			return 0;
+		QByteArray name(data + pos, len);
+		pos += len;
+		schema.column_types.push_back(type);
+
+		/// unknown fields of newer versions are skipped
+		for(int f = 0; f < FIELD_COUNT; f++){
+			if(name == fields[f].name){
+				schema.offsets[f] = offset;
+				schema.types[f] = type;
+				break;
+			}
+		}
+		offset += type_size(type);
+	}
+	schema.record_size = offset;
+
+	return pos;
+}
+
+void TelemetryFormat::encode(const StructTelemetry &st, uchar *dst)
+{
+	put_f64(dst, st.bank);
+	put_f64(dst, st.course);
+	put_f64(dst, st.tangaj);
+	put_f64(dst, st.height);
+	put_f64(dst, st.gyroscope.temp);
+
+	put_i32(dst, st.gyroscope.accel.x());
+	put_i32(dst, st.gyroscope.accel.y());
+	put_i32(dst, st.gyroscope.accel.z());
+
+	put_i32(dst, st.gyroscope.gyro.x());
+	put_i32(dst, st.gyroscope.gyro.y());
+	put_i32(dst, st.gyroscope.gyro.z());
+
+	put_i32(dst, st.gyroscope.afs_sel);
+	put_i32(dst, st.gyroscope.fs_sel);
+	put_i32(dst, st.gyroscope.freq);
+	put_i64(dst, st.gyroscope.tick);
+
+	put_i32(dst, st.compass.data.x());
+	put_i32(dst, st.compass.data.y());
+	put_i32(dst, st.compass.data.z());
+	put_i64(dst, st.compass.tick);
+
+	put_i32(dst, st.barometer.data);
+	put_i32(dst, st.barometer.temp);
+	put_i64(dst, st.barometer.tick);
+}
+
+void TelemetryFormat::decode(const uchar *src, const TelemetrySchema &schema, StructTelemetry &st)
+{
+#define GETV(field) get_value(src, schema.offsets[field], schema.types[field])
+#define GETI(field) get_int(src, schema.offsets[field], schema.types[field])
+
+	st.bank = GETV(BANK);
+	st.course = GETV(COURSE);
+	st.tangaj = GETV(TANGAJ);
+	st.height = GETV(HEIGHT);
+	st.gyroscope.temp = GETV(GYRO_TEMP);
+
+	st.gyroscope.accel = Vector3i(GETI(ACCEL_X), GETI(ACCEL_Y), GETI(ACCEL_Z));
+	st.gyroscope.gyro = Vector3i(GETI(GYRO_X), GETI(GYRO_Y), GETI(GYRO_Z));
+
+	st.gyroscope.afs_sel = GETI(AFS_SEL);
+	st.gyroscope.fs_sel = GETI(FS_SEL);
+	st.gyroscope.freq = GETI(FREQ);
+	st.gyroscope.tick = GETI(GYRO_TICK);
+
+	st.compass.data = Vector3i(GETI(COMPASS_X), GETI(COMPASS_Y), GETI(COMPASS_Z));
+	st.compass.tick = GETI(COMPASS_TICK);
+
+	st.barometer.data = GETI(BARO_DATA);
+	st.barometer.temp = GETI(BARO_TEMP);
+	st.barometer.tick = GETI(BARO_TICK);
+
+#undef GETV
+#undef GETI
+}
+
+void TelemetryFormat::encode_csv(const StructTelemetry &st, QByteArray &dst)
+{
+#define ADDVAL(val) dst += QByteArray::number(val); dst += ';'
+
+	ADDVAL(st.bank);
+	ADDVAL(st.course);
+	ADDVAL(st.tangaj);
+	ADDVAL(st.height);
+	ADDVAL(st.gyroscope.temp);
+
+	ADDVAL(st.gyroscope.accel.x());
+	ADDVAL(st.gyroscope.accel.y());
+	ADDVAL(st.gyroscope.accel.z());
+
+	ADDVAL(st.gyroscope.gyro.x());
+	ADDVAL(st.gyroscope.gyro.y());
+	ADDVAL(st.gyroscope.gyro.z());
+
+	ADDVAL(st.gyroscope.afs_sel);
+	ADDVAL(st.gyroscope.fs_sel);
+	ADDVAL(st.gyroscope.freq);
+	ADDVAL(st.gyroscope.tick);
+
+	ADDVAL(st.compass.data.x());
+	ADDVAL(st.compass.data.y());
+	ADDVAL(st.compass.data.z());
+	ADDVAL(st.compass.tick);
+
+	ADDVAL(st.barometer.data);
+	ADDVAL(st.barometer.temp);
+	ADDVAL(st.barometer.tick);
+
+#undef ADDVAL
+
+	dst += '\n';
+}
+
+QString TelemetryFormat::extension(TelemetryFormat::Format format)
+{
+	switch (format) {
+		case Binary:
+			return ".glsb";
+		case Compressed:
+			return ".glsz";
+		case CSV:
+		default:
+			return ".csv";
+	}
+}
@@ -0,0 +1,144 @@
+#ifndef TELEMETRYFORMAT_H
+#define TELEMETRYFORMAT_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+
+#include <struct_controls.h>
+
+////////////////////////////////////
+/// \brief The TelemetrySchema struct
+/// layout of the fields in the binary record read from the header
+struct TelemetrySchema{
+	TelemetrySchema();
+
+	/// offset of each TelemetryFormat::Field in the record or -1
+	QVector< int > offsets;
+	/// type of each TelemetryFormat::Field
+	QVector< int > types;
+	/// types of all columns of the file in order of the record, including unknown fields
+	QVector< int > column_types;
+	int record_size;
+
+	bool is_valid() const { return record_size > 0; }
+};
+
+////////////////////////////////////
+/// \brief The TelemetryFormat class
+/// binary log of telemetry:
+/// header: magic "GLSB", version (u16), count of fields (u16), for each field: type (u8), length of name (u8), name;
+/// then fixed size little-endian records with fields in order of the header
+class TelemetryFormat
+{
+public:
+	enum Format{
+		CSV,
+		Binary,
+		Compressed
+	};
+
+	enum FieldType{
+		F64 = 1,
+		I32,
+		I64
+	};
+
+	enum Field{
+		BANK,
+		COURSE,
+		TANGAJ,
+		HEIGHT,
+		GYRO_TEMP,
+		ACCEL_X,
+		ACCEL_Y,
+		ACCEL_Z,
+		GYRO_X,
+		GYRO_Y,
+		GYRO_Z,
+		AFS_SEL,
+		FS_SEL,
+		FREQ,
+		GYRO_TICK,
+		COMPASS_X,
+		COMPASS_Y,
+		COMPASS_Z,
+		COMPASS_TICK,
+		BARO_DATA,
+		BARO_TEMP,
+		BARO_TICK,
+		FIELD_COUNT
+	};
+
+	static const char magic[4];
+	static const quint16 version = 1;
+
+	/**
+	 * @brief record_size
+	 * size of the record of the current version
+	 * @return
+	 */
+	static int record_size();
+	/**
+	 * @brief field_name
+	 * @param field
+	 * @return
+	 */
+	static const char* field_name(int field);
+	static int field_type(int field);
+	/**
+	 * @brief type_size
+	 * @param type - FieldType
+	 * @return size in bytes or 0 for unknown type
+	 */
+	static int type_size(int type);
+	/**
+	 * @brief header
+	 * header of the current version with the schema
+	 * @return
+	 */
+	static QByteArray header();
+	/**
+	 * @brief read_header
+	 * @param data
+	 * @param size
+	 * @param schema - layout of the records in the file
+	 * @return size of the header or 0 if data is not a binary log
+	 */
+	static int read_header(const char* data, int size, TelemetrySchema& schema);
+	/**
+	 * @brief encode
+	 * write the record of the current version to dst. dst must have record_size() bytes
+	 * @param st
+	 * @param dst
+	 */
+	static void encode(const sc::StructTelemetry& st, uchar* dst);
+	/**
+	 * @brief decode
+	 * @param src - record
+	 * @param schema - layout of the record
+	 * @param st
+	 */
+	static void decode(const uchar* src, const TelemetrySchema& schema, sc::StructTelemetry& st);
+	/**
+	 * @brief encode_csv
+	 * append a line with 22 fields separated by ';'
+	 * @param st
+	 * @param dst
+	 */
+	static void encode_csv(const sc::StructTelemetry& st, QByteArray& dst);
+	/**
+	 * @brief extension
+	 * extension of the log file for the format
+	 * @param format
+	 * @return
+	 */
+	static QString extension(Format format);
+	/**
+	 * @brief current_schema
+	 * @return
+	 */
+	static const TelemetrySchema& current_schema();
+};
+
+#endif // TELEMETRYFORMAT_H
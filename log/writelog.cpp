@@ -3,22 +3,60 @@
 #include <QTextStream>
 #include <QDateTime>
 #include <QDir>
+#include <QFileInfo>
 #include <QApplication>
+#include <QElapsedTimer>
+
+#include <string.h>
 
 using namespace sc;
 
-LogFile::LogFile()
+/// maximum count of records drained for one call of pop, does not depend on the batch threshold of the writer
+const size_t max_pop_records = 4096;
+/// reserved size of the csv line in the record
+const int reserve_csv_line = 512;
+/// maximum age of the partial block of the compressed log in ms
+const int max_block_age = 1000;
+
+void LogRecord::set(const char *src, int len, qint64 tick)
 {
-	max_line_in_buffer = 1000;
+	this->tick = tick;
+	if(len <= inline_size){
+		memcpy(data, src, len);
+		size = len;
+	}else{
+		large = QByteArray(src, len);
+		size = -1;
+	}
 }
 
-LogFile::LogFile(const LogFile &log)
+////////////////////////////////////////
+
+LogFile::LogFile(size_t capacity)
+	: format(TelemetryFormat::CSV)
+	, queue(capacity)
+	, m_is_open(false)
+	, m_spilling(false)
+	, m_lossless(true)
+	, m_max_spill_size(default_max_spill_size)
+	, m_enqueued(0)
+	, m_written(0)
+	, m_dropped(0)
+	, m_spilled(0)
+	, m_write_errors(0)
+	, m_block_count(0)
+	, m_block_first_tick(0)
+	, m_chunk_number(0)
+	, m_records_from_point(0)
+	, m_written_last_tick(0)
+	, m_written_count(0)
+	, m_provisional_count(0)
+	, m_provisional_points(0)
+	, m_rotate_size((qint64)default_rotate_size * 1024 * 1024)
+	, m_rotate_duration(default_rotate_duration)
+	, m_flush_interval(default_flush_interval)
 {
-	fileName = log.fileName;
-	name = log.name;
-	logFile.setFileName(log.logFile.fileName());
-	max_line_in_buffer = log.max_line_in_buffer;
-	data = log.data;
+	m_block.reserve(TelemetryCompression::default_block_records * TelemetryFormat::record_size());
 }
 
 LogFile::~LogFile()
@@ -26,18 +64,72 @@ LogFile::~LogFile()
 	logFile.close();
 }
 
-LogFile &LogFile::operator=(const LogFile &log)
+bool LogFile::is_open() const
+{
+	return m_is_open.load(std::memory_order_acquire);
+}
+
+void LogFile::set_lossless(bool value)
+{
+	m_lossless = value;
+}
+
+bool LogFile::is_lossless() const
+{
+	return m_lossless;
+}
+
+void LogFile::set_max_spill_size(int value)
+{
+	m_max_spill_size = qMax(0, value);
+}
+
+void LogFile::set_rotation(qint64 max_size, int max_duration)
+{
+	m_rotate_size = qMax(0ll, max_size);
+	m_rotate_duration = qMax(0, max_duration);
+}
+
+void LogFile::set_flush_interval(int value)
 {
-	fileName = log.fileName;
-	name = log.name;
-	logFile.setFileName(log.logFile.fileName());
-	max_line_in_buffer = log.max_line_in_buffer;
-	data = log.data;
+	m_flush_interval = qMax(0, value);
+}
 
-	return *this;
+LogStatistic LogFile::statistic() const
+{
+	LogStatistic res;
+	res.enqueued = m_enqueued;
+	res.written = m_written;
+	res.dropped = m_dropped;
+	res.spilled = m_spilled;
+	res.write_errors = m_write_errors;
+	return res;
 }
 
 void LogFile::openFile(const QString &name)
+{
+	QMutexLocker lock(&m_file_mutex);
+	if(logFile.isOpen()){
+		write_pending(true);
+		finish_chunk();
+		logFile.close();
+	}
+	open_file(name);
+}
+
+void LogFile::open(const QString &name, TelemetryFormat::Format format)
+{
+	if(is_open())
+		return;
+
+	QMutexLocker lock(&m_file_mutex);
+	if(logFile.isOpen())
+		return;
+	this->format = format;
+	open_file(name);
+}
+
+void LogFile::open_file(const QString &name)
 {
 	if(name.isEmpty())
 		return;
@@ -50,68 +142,324 @@ void LogFile::openFile(const QString &name)
 		dir.mkdir(log_path);
 	}
 
-	QString fn = log_path + name + "_" + QDateTime::currentDateTime().toString("yyyy_MMMM_dd_hh_mm_ss") + ".csv";
+	m_session = log_path + name + "_" + QDateTime::currentDateTime().toString("yyyy_MMMM_dd_hh_mm_ss");
+	m_chunk_number = 0;
+
+	this->name = name;
+
+	QFile::remove(m_session + LogIndex::extension());
+
+	open_chunk();
+}
+
+void LogFile::open_chunk()
+{
+	/// the first file of the session has no number
+	QString fn = m_session;
+	if(m_chunk_number)
+		fn += QString("_%1").arg(m_chunk_number, 3, 10, QChar('0'));
+	fn += TelemetryFormat::extension(format);
 
 	if(QFile::exists(fn)){
 		QFile::remove(fn);
 	}
-	logFile.setFileName(fn);
 	fileName = fn;
 
-	this->name = name;
+	m_chunk = LogIndexChunk();
+	m_chunk.file = QFileInfo(fn).fileName();
+	m_records_from_point = 0;
+	m_written_last_tick = 0;
+	m_written_count = 0;
+	m_provisional_count = 0;
+	m_provisional_points = 0;
+	m_chunk_timer.start();
+	m_flush_timer.start();
+
+	logFile.open(fn);
+
+	if(format == TelemetryFormat::Binary){
+		logFile.write(TelemetryFormat::header());
+	}
+	if(format == TelemetryFormat::Compressed){
+		logFile.write(TelemetryCompression::header(TelemetryCompression::default_codec()));
+		m_block.resize(0);
+		m_block_count = 0;
+		m_block_timer.start();
+	}
+	m_is_open.store(logFile.isOpen(), std::memory_order_release);
+}
+
+void LogFile::finish_chunk()
+{
+	write_block();
+
+	m_chunk.size = logFile.size();
+	if(m_chunk.count)
+		LogIndex::append(m_session + LogIndex::extension(), m_chunk);
+	m_chunk = LogIndexChunk();
+}
+
+void LogFile::write_provisional()
+{
+	if(!m_written_count || m_written_count == m_provisional_count)
+		return;
+
+	LogIndexChunk chunk;
+	chunk.file = m_chunk.file;
+	chunk.first_tick = m_chunk.first_tick;
+	chunk.last_tick = m_written_last_tick;
+	chunk.count = m_written_count;
+	chunk.size = logFile.size();
+	chunk.points = m_chunk.points.mid(m_provisional_points);
+	if(!LogIndex::append_provisional(m_session + LogIndex::extension(), chunk))
+		return;
+
+	m_provisional_count = m_written_count;
+	m_provisional_points = m_chunk.points.size();
+}
+
+bool LogFile::need_rotate() const
+{
+	if(m_rotate_size > 0 && logFile.size() >= m_rotate_size)
+		return true;
+	if(m_rotate_duration > 0 && m_chunk_timer.elapsed() >= m_rotate_duration * 1000ll)
+		return true;
+	return false;
+}
+
+void LogFile::write_spill()
+{
+	QByteArray spill;
+	QVector< SpillRecord > records;
+
+	m_spill_mutex.lock();
+	spill.swap(m_spill);
+	records.swap(m_spill_records);
+	m_spilling.store(false, std::memory_order_release);
+	m_spill_mutex.unlock();
+
+	const char* data = spill.constData();
+	foreach (const SpillRecord& rec, records) {
+		if(put_record(data, rec.size, rec.tick))
+			m_written++;
+		else
+			m_dropped++;
+		data += rec.size;
+	}
+}
+
+bool LogFile::put_record(const char *data, int size, qint64 tick)
+{
+	/// only records of the telemetry are packed, others are counted as lost
+	if(format == TelemetryFormat::Compressed && size != TelemetryFormat::record_size())
+		return false;
+
+	if(tick >= 0){
+		if(!m_chunk.count)
+			m_chunk.first_tick = tick;
+		m_chunk.last_tick = tick;
+		m_chunk.count++;
+	}
+
+	if(format != TelemetryFormat::Compressed){
+		/// sparse point at the offset of the record
+		if(tick >= 0){
+			if(!m_records_from_point)
+				m_chunk.points.push_back(LogIndexPoint(tick, logFile.size()));
+			m_records_from_point = (m_records_from_point + 1) % index_interval;
+		}
+		logFile.write(data, size);
+		if(tick >= 0){
+			m_written_last_tick = tick;
+			m_written_count = m_chunk.count;
+		}
+		return true;
+	}
+
+	if(!m_block_count)
+		m_block_first_tick = tick;
+	m_block.append(data, size);
+	m_block_count++;
+	if(m_block_count >= TelemetryCompression::default_block_records)
+		write_block();
+	return true;
+}
+
+void LogFile::write_block()
+{
+	if(!m_block_count)
+		return;
 
-	logFile.open(QIODevice::WriteOnly);
+	/// sparse point at each block
+	if(m_block_first_tick >= 0)
+		m_chunk.points.push_back(LogIndexPoint(m_block_first_tick, logFile.size()));
+
+	m_block_out.resize(0);
+	TelemetryCompression::encode_block((const uchar*)m_block.constData(), m_block_count,
+									   TelemetryCompression::default_codec(), m_block_out);
+	logFile.write(m_block_out);
+	/// all records of the file are in blocks now
+	m_written_last_tick = m_chunk.last_tick;
+	m_written_count = m_chunk.count;
+
+	m_block.resize(0);
+	m_block_count = 0;
+	m_block_timer.restart();
 }
 
 void LogFile::write_data()
+{
+	QMutexLocker lock(&m_file_mutex);
+	write_pending();
+}
+
+void LogFile::write_pending(bool finish)
 {
 	if(!logFile.isOpen())
 		return;
 
-	while(data.size()){
-		m_mutex.lock();
-		QString dt = data.front() + "\n";
-		logFile.write(dt.toUtf8());
-		data.pop_front();
-		m_mutex.unlock();
+	/// records are copied to the blocks of the writer, full blocks go to the disk asynchronously
+	size_t count;
+	do{
+		size_t rejected = 0;
+		count = queue.pop([this, &rejected](LogRecord& rec){
+			if(!put_record(rec.constData(), rec.length(), rec.tick))
+				rejected++;
+		}, max_pop_records);
+		m_written += count - rejected;
+		m_dropped += rejected;
+	}while(count);
+
+	/// the spill buffer has records newer than the queue
+	if(m_spilling.load(std::memory_order_acquire)){
+		write_spill();
+	}
+
+	/// the partial block is written at the end of the log or when it is too old
+	if(m_block_count && (finish || m_block_timer.elapsed() > max_block_age)){
+		write_block();
+	}
+
+	/// the partial block of the writer goes to the disk only at the end of the file
+	/// or for the durability, so the disk gets large blocks
+	if(finish || m_flush_timer.elapsed() >= m_flush_interval){
+		logFile.flush();
+		m_flush_timer.restart();
+		/// the index knows the open file if the log is not closed normally
+		if(!finish)
+			write_provisional();
+	}
+	m_write_errors = logFile.errors();
+
+	if(!finish && need_rotate()){
+		finish_chunk();
+		logFile.close();
+		m_chunk_number++;
+		open_chunk();
+	}
+}
+
+template< typename F >
+bool LogFile::push_record(F fill)
+{
+	if(!m_spilling.load(std::memory_order_acquire) && queue.push(fill)){
+		m_enqueued++;
+		return true;
+	}
+
+	if(!m_lossless){
+		m_dropped++;
+		return false;
+	}
+
+	LogRecord rec;
+	fill(rec);
+
+	QMutexLocker lock(&m_spill_mutex);
+	if(m_spill.size() + rec.length() > m_max_spill_size){
+		m_dropped++;
+		return false;
 	}
-	logFile.flush();
+	m_spill.append(rec.constData(), rec.length());
+	SpillRecord spill_record = { rec.length(), rec.tick };
+	m_spill_records.push_back(spill_record);
+	m_spilling.store(true, std::memory_order_release);
+
+	m_enqueued++;
+	m_spilled++;
+	return true;
+}
+
+bool LogFile::push_data(const QString& name, const QString &str)
+{
+	QByteArray line = str.toUtf8();
+	line += '\n';
+	return push_data(name, line.constData(), line.size());
 }
 
-void LogFile::push_data(const QString& name, const QString &str)
+bool LogFile::push_data(const QString &name, const char *data, int size)
 {
 	if(name.isEmpty())
-		return;
+		return false;
 
-	while(data.size() >= max_line_in_buffer){
-		m_mutex.lock();
-		data.pop_front();
-		m_mutex.unlock();
+	if(!is_open()){
+		open(name, format);
 	}
 
-	if(!logFile.isOpen()){
-		openFile(name);
+	return push_record([data, size](LogRecord& rec){
+		rec.set(data, size);
+	});
+}
+
+bool LogFile::push_telemetry(const QString &name, const StructTelemetry &st)
+{
+	if(name.isEmpty())
+		return false;
+
+	if(!is_open()){
+		open(name, format);
 	}
-	m_mutex.lock();
-	data.push_back(str);
-	m_mutex.unlock();
+
+	/// the compressed log gets binary records and packs them to blocks in the writer
+	const bool binary = format != TelemetryFormat::CSV;
+	return push_record([&st, binary](LogRecord& rec){
+		rec.tick = st.gyroscope.tick;
+		if(binary){
+			TelemetryFormat::encode(st, (uchar*)rec.data);
+			rec.size = TelemetryFormat::record_size();
+		}else{
+			/// the capacity of the line stays with the cell
+			if(!rec.large.capacity())
+				rec.large.reserve(reserve_csv_line);
+			rec.large.resize(0);
+			TelemetryFormat::encode_csv(st, rec.large);
+			rec.size = -1;
+		}
+	});
 }
 
 void LogFile::newLog()
 {
+	QMutexLocker lock(&m_file_mutex);
 	if(name.isEmpty())
 		return;
 
-	data.clear();
+	m_is_open.store(false, std::memory_order_release);
 
+	/// pending records stay in the previous log
+	write_pending(true);
+	finish_chunk();
 	logFile.close();
-	openFile(name);
+	open_file(name);
 }
 
 void LogFile::close()
 {
-	data.clear();
+	QMutexLocker lock(&m_file_mutex);
+	m_is_open.store(false, std::memory_order_release);
 
+	write_pending(true);
+	finish_chunk();
 	logFile.close();
 }
 
@@ -122,14 +470,27 @@ WriteLog *WriteLog::m_instance = 0;
 WriteLog::WriteLog(QObject *parent):
 	QThread(parent)
   , m_write_log(true)
+  , m_telemetry_format(TelemetryFormat::Binary)
+  , m_queue_capacity(LogFile::default_queue_capacity)
+  , m_lossless(true)
+  , m_max_spill_size(LogFile::default_max_spill_size)
+  , m_rotate_size(LogFile::default_rotate_size)
+  , m_rotate_duration(LogFile::default_rotate_duration)
+  , m_flush_interval(LogFile::default_flush_interval)
+  , m_pending(0)
+  , m_batch_records(default_batch_records)
+  , m_max_latency(default_max_latency)
+  , m_stop(false)
 {
 
 }
 
 WriteLog::~WriteLog()
 {
-	quit();
+	stop();
 	wait();
+
+	qDeleteAll(m_logFiles);
 }
 
 WriteLog *WriteLog::instance()
@@ -142,17 +503,37 @@ WriteLog *WriteLog::instance()
 	return m_instance;
 }
 
+void WriteLog::release()
+{
+	if(!m_instance)
+		return;
+
+	m_instance->stop();
+	m_instance->wait();
+	delete m_instance;
+	m_instance = 0;
+}
+
+void WriteLog::stop()
+{
+	QMutexLocker lock(&m_wait_mutex);
+	m_stop = true;
+	m_wait_cond.wakeAll();
+}
+
 void WriteLog::clearLogs()
 {
-	for(QMap< QString, LogFile >::iterator it = m_logFiles.begin(); it != m_logFiles.end(); it++){
-		it.value().close();
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->close();
 	}
 }
 
 void WriteLog::newLogs()
 {
-	for(QMap< QString, LogFile >::iterator it = m_logFiles.begin(); it != m_logFiles.end(); it++){
-		it.value().newLog();
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->newLog();
 	}
 }
 
@@ -169,16 +550,38 @@ bool WriteLog::is_write_log() const
 	return m_write_log;
 }
 
+LogFile *WriteLog::log_file(const QString &name)
+{
+	{
+		QReadLocker lock(&m_lock_logs);
+		QMap< QString, LogFile* >::const_iterator it = m_logFiles.find(name);
+		if(it != m_logFiles.end())
+			return it.value();
+	}
+
+	QWriteLocker lock(&m_lock_logs);
+	LogFile*& log = m_logFiles[name];
+	if(!log){
+		log = new LogFile(m_queue_capacity);
+		log->set_lossless(m_lossless);
+		log->set_max_spill_size(m_max_spill_size);
+		log->set_rotation((qint64)m_rotate_size * 1024 * 1024, m_rotate_duration);
+		log->set_flush_interval(m_flush_interval);
+	}
+	return log;
+}
+
 void WriteLog::createLog(const QString &name)
 {
-	m_logFiles[name].openFile(name);
+	log_file(name)->openFile(name);
 }
 
 void WriteLog::add_data(const QString &name, const QString &data)
 {
 	if(!m_write_log)
 		return;
-	m_logFiles[name].push_data(name, data);
+	if(log_file(name)->push_data(name, data))
+		notify_writer();
 }
 
 void WriteLog::add_data(const QString &name, const StructTelemetry &data)
@@ -186,51 +589,138 @@ void WriteLog::add_data(const QString &name, const StructTelemetry &data)
 	if(!m_write_log)
 		return;
 
-	QString str;
+	LogFile* log = log_file(name);
+	if(!log->is_open())
+		log->open(name, m_telemetry_format);
+	if(log->push_telemetry(name, data))
+		notify_writer();
+}
+
+void WriteLog::write_data(const QString &name, const QVector<StructTelemetry> &data)
+{
+	write_data(name, data.size(), [&data](int index){
+		return data[index];
+	});
+}
+
+void WriteLog::write_data(const QString &name, int count, const std::function<StructTelemetry (int)> &sample)
+{
+	if(!m_write_log)
+		return;
 
-#define ADDVAL(val) str += QString::number(val) + ";"
+	/// export of recorded data always in csv
+	LogFile* log = log_file(name);
+	log->close();
+	log->open(name, TelemetryFormat::CSV);
+
+	for(int i = 0; i < count; i++){
+		const StructTelemetry st = sample(i);
+		/// the queue is full: drain it here and repeat
+		while(!log->push_telemetry(name, st)){
+			log->write_data();
+		}
+	}
+	log->write_data();
+	log->close();
+}
 
-	ADDVAL(data.bank);
-	ADDVAL(data.course);
-	ADDVAL(data.tangaj);
-	ADDVAL(data.height);
-	ADDVAL(data.gyroscope.temp);
+void WriteLog::set_telemetry_format(TelemetryFormat::Format format)
+{
+	m_telemetry_format = format;
+}
 
-	ADDVAL(data.gyroscope.accel.x());
-	ADDVAL(data.gyroscope.accel.y());
-	ADDVAL(data.gyroscope.accel.z());
+TelemetryFormat::Format WriteLog::telemetry_format() const
+{
+	return m_telemetry_format;
+}
 
-	ADDVAL(data.gyroscope.gyro.x());
-	ADDVAL(data.gyroscope.gyro.y());
-	ADDVAL(data.gyroscope.gyro.z());
+void WriteLog::set_queue_capacity(int value)
+{
+	m_queue_capacity = qMax(2, value);
+}
 
-	ADDVAL(data.gyroscope.afs_sel);
-	ADDVAL(data.gyroscope.fs_sel);
-	ADDVAL(data.gyroscope.freq);
-	ADDVAL(data.gyroscope.tick);
+int WriteLog::queue_capacity() const
+{
+	return m_queue_capacity;
+}
 
-	ADDVAL(data.compass.data.x());
-	ADDVAL(data.compass.data.y());
-	ADDVAL(data.compass.data.z());
-	ADDVAL(data.compass.tick);
+void WriteLog::set_lossless(bool value)
+{
+	m_lossless = value;
 
-	ADDVAL(data.barometer.data);
-	ADDVAL(data.barometer.temp);
-	ADDVAL(data.barometer.tick);
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->set_lossless(value);
+	}
+}
 
-	m_logFiles[name].push_data(name, str);
+bool WriteLog::is_lossless() const
+{
+	return m_lossless;
 }
 
-void WriteLog::write_data(const QString &name, const QVector<StructTelemetry> &data)
+void WriteLog::set_max_spill_size(int value)
 {
-	if(!m_write_log)
-		return;
+	m_max_spill_size = value;
+
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->set_max_spill_size(value);
+	}
+}
+
+int WriteLog::max_spill_size() const
+{
+	return m_max_spill_size;
+}
+
+void WriteLog::set_rotation(int max_size, int max_duration)
+{
+	m_rotate_size = qMax(0, max_size);
+	m_rotate_duration = qMax(0, max_duration);
+
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->set_rotation((qint64)m_rotate_size * 1024 * 1024, m_rotate_duration);
+	}
+}
+
+int WriteLog::rotate_size() const
+{
+	return m_rotate_size;
+}
+
+int WriteLog::rotate_duration() const
+{
+	return m_rotate_duration;
+}
+
+void WriteLog::set_flush_interval(int value)
+{
+	m_flush_interval = qMax(0, value);
+
+	QReadLocker lock(&m_lock_logs);
+	foreach (LogFile* log, m_logFiles) {
+		log->set_flush_interval(m_flush_interval);
+	}
+}
+
+int WriteLog::flush_interval() const
+{
+	return m_flush_interval;
+}
+
+QList<LogStatistic> WriteLog::statistic()
+{
+	QList< LogStatistic > res;
 
-	foreach (StructTelemetry st, data) {
-		add_data(name, st);
-		m_logFiles[name].write_data();
+	QReadLocker lock(&m_lock_logs);
+	for(QMap< QString, LogFile* >::iterator it = m_logFiles.begin(); it != m_logFiles.end(); it++){
+		LogStatistic stat = it.value()->statistic();
+		stat.name = it.key();
+		res.push_back(stat);
 	}
-	m_logFiles[name].close();
+	return res;
 }
 
 void WriteLog::_on_timeout()
@@ -238,21 +728,96 @@ void WriteLog::_on_timeout()
 	if(!m_write_log)
 		return;
 
-	for(QMap< QString, LogFile >::iterator it = m_logFiles.begin(); it != m_logFiles.end(); it++){
-		it.value().write_data();
+	QReadLocker lock(&m_lock_logs);
+	for(QMap< QString, LogFile* >::iterator it = m_logFiles.begin(); it != m_logFiles.end(); it++){
+		LogFile* log = it.value();
+		log->write_data();
+
+		/// warn at the first check after the loss
+		LogStatistic stat = log->statistic();
+		quint64& reported = m_reported_dropped[it.key()];
+		if(stat.dropped > reported){
+			QString text = QString("log \"%1\": %2 records lost (enqueued %3, written %4, spilled %5)")
+					.arg(it.key())
+					.arg(stat.dropped - reported)
+					.arg(stat.enqueued)
+					.arg(stat.written)
+					.arg(stat.spilled);
+			qWarning("%s", text.toLocal8Bit().constData());
+			emit add_to_log(text);
+			reported = stat.dropped;
+		}
+
+		int& reported_errors = m_reported_errors[it.key()];
+		if(stat.write_errors > reported_errors){
+			QString text = QString("log \"%1\": %2 blocks are not written to the disk")
+					.arg(it.key())
+					.arg(stat.write_errors - reported_errors);
+			qWarning("%s", text.toLocal8Bit().constData());
+			emit add_to_log(text);
+		}
+		reported_errors = stat.write_errors;
+	}
+}
+
+void WriteLog::set_flush_thresholds(int records, int max_latency)
+{
+	m_batch_records = qMax(1, records);
+	m_max_latency = qMax(1, max_latency);
+}
+
+int WriteLog::batch_records() const
+{
+	return m_batch_records;
+}
+
+int WriteLog::max_latency() const
+{
+	return m_max_latency;
+}
+
+void WriteLog::notify_writer()
+{
+	int pending = ++m_pending;
+	if(pending == 1 || pending == m_batch_records){
+		QMutexLocker lock(&m_wait_mutex);
+		m_wait_cond.wakeOne();
+	}
+}
+
+void WriteLog::wait_records()
+{
+	QMutexLocker lock(&m_wait_mutex);
+
+	/// idle: nothing to write
+	while(!m_stop && !m_pending){
+		m_wait_cond.wait(&m_wait_mutex);
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	qint64 remain = m_max_latency;
+	while(!m_stop && m_pending < m_batch_records && remain > 0){
+		m_wait_cond.wait(&m_wait_mutex, remain);
+		remain = m_max_latency - timer.elapsed();
 	}
 }
 
 void WriteLog::run()
 {
-	while(1){
-		_on_timeout();
+	while(!m_stop){
+		wait_records();
 
-		QThread::msleep(300);
+		m_pending = 0;
+		_on_timeout();
 	}
+
+	/// drain the rest and close files
+	_on_timeout();
+	clearLogs();
 }
 
 void WriteLog::closeLog(const QString &name)
 {
-	m_logFiles[name].close();
+	log_file(name)->close();
 }
@@ -7,45 +7,250 @@
 #include <QVector>
 #include <QFile>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <functional>
 
 #include <global.h>
 #include <struct_controls.h>
 
+#include "telemetryformat.h"
+#include "mpscqueue.h"
+#include "blockwriter.h"
+#include "telemetrycompression.h"
+#include "logindex.h"
+
 //////////////////////////////////////
-/// \brief The LogFile struct
-/// struct for write data to log file
+/// \brief The LogRecord struct
+/// preformatted record in the queue of the log.
+/// short records are stored in place, long ones in the byte array
+struct LogRecord{
+	enum{ inline_size = 256 };
+
+	LogRecord(): size(0), tick(-1) {}
+
+	/// size of the data in place or -1 if the record is in large
+	int size;
+	/// tick of the device for the index or -1
+	qint64 tick;
+	char data[inline_size];
+	QByteArray large;
+
+	void set(const char* src, int len, qint64 tick = -1);
+	const char* constData() const { return size >= 0? data : large.constData(); }
+	int length() const { return size >= 0? size : large.size(); }
+};
+
+//////////////////////////////////////
+/// \brief The LogStatistic struct
+/// counters of records of the log
+struct LogStatistic{
+	LogStatistic(): enqueued(0), written(0), dropped(0), spilled(0), write_errors(0) {}
+
+	QString name;
+	/// accepted records (in the queue or in the spill buffer)
+	quint64 enqueued;
+	/// records written to the file
+	quint64 written;
+	/// lost records
+	quint64 dropped;
+	/// records passed through the spill buffer
+	quint64 spilled;
+	/// blocks failed to write to the disk in the current file
+	int write_errors;
+};
 
+//////////////////////////////////////
+/// \brief The LogFile struct
+/// struct for write data to log file.
+/// producers push records to the lock-free queue without blocking,
+/// the thread of the WriteLog drains the queue in batches.
+/// in the lossless mode records go to the spill buffer when the queue is full
+/// and are dropped only when the spill buffer is full too
 struct LogFile{
+	enum{ default_queue_capacity = 16384 };
+	enum{ default_max_spill_size = 64 * 1024 * 1024 };
+	/// defaults of the rotation: size in MiB and duration in seconds
+	enum{ default_rotate_size = 512, default_rotate_duration = 3600 };
+	/// count of records between sparse points of the index
+	enum{ index_interval = 4096 };
+	/// interval of the submit of the partial block of the writer in ms
+	enum{ default_flush_interval = 1000 };
+
 	QString fileName;
 	QString name;
-	QVector< QString > data;
-	QFile logFile;
-	int max_line_in_buffer;
-	QMutex m_mutex;
+	BlockWriter logFile;
+	TelemetryFormat::Format format;
+	MpscQueue< LogRecord > queue;
 
-	LogFile();
-	explicit LogFile(const LogFile& log);
+	explicit LogFile(size_t capacity = default_queue_capacity);
 	~LogFile();
 
-	LogFile &operator=( const LogFile& log );
+	bool is_open() const;
+
+	void set_lossless(bool value);
+	bool is_lossless() const;
+	/**
+	 * @brief set_max_spill_size
+	 * @param value - maximum size of the spill buffer in bytes
+	 */
+	void set_max_spill_size(int value);
+	/**
+	 * @brief set_rotation
+	 * the log continues in the next file of the session when one of limits is reached
+	 * @param max_size - size of the file in bytes, 0 to disable
+	 * @param max_duration - duration of the file in seconds, 0 to disable
+	 */
+	void set_rotation(qint64 max_size, int max_duration);
+	/**
+	 * @brief set_flush_interval
+	 * @param value - interval of the submit of the partial block of the writer in ms, 0 for each write
+	 */
+	void set_flush_interval(int value);
+	LogStatistic statistic() const;
 
 	void openFile(const QString& name);
+	/**
+	 * @brief open
+	 * open the log with the format if it is not opened yet
+	 * @param name
+	 * @param format
+	 */
+	void open(const QString& name, TelemetryFormat::Format format);
+	/**
+	 * @brief write_data
+	 * drain the queue to the file
+	 */
 	void write_data();
-	void push_data(const QString& name, const QString& str);
+	/**
+	 * @brief push_data
+	 * @param name
+	 * @param str
+	 * @return false if the queue is full and the record is lost
+	 */
+	bool push_data(const QString& name, const QString& str);
+	/**
+	 * @brief push_data
+	 * push the encoded record
+	 * @param name
+	 * @param data
+	 * @param size
+	 * @return false if the queue is full and the record is lost
+	 */
+	bool push_data(const QString& name, const char* data, int size);
+	/**
+	 * @brief push_telemetry
+	 * encode the telemetry in the format of the log directly to the cell of the queue
+	 * @param name
+	 * @param st
+	 * @return false if the queue is full and the record is lost
+	 */
+	bool push_telemetry(const QString& name, const sc::StructTelemetry& st);
 	void newLog();
 	void close();
+
+private:
+	Q_DISABLE_COPY(LogFile)
+
+	/// guards the file and the consumer side of the queue
+	QMutex m_file_mutex;
+	std::atomic< bool > m_is_open;
+
+	struct SpillRecord{
+		int size;
+		qint64 tick;
+	};
+
+	/// records after the overflow of the queue. guarded by m_spill_mutex
+	QByteArray m_spill;
+	QVector< SpillRecord > m_spill_records;
+	QMutex m_spill_mutex;
+	/// set while the spill buffer is not empty: new records go to it to keep the order
+	std::atomic< bool > m_spilling;
+	std::atomic< bool > m_lossless;
+	std::atomic< int > m_max_spill_size;
+
+	std::atomic< quint64 > m_enqueued;
+	std::atomic< quint64 > m_written;
+	std::atomic< quint64 > m_dropped;
+	std::atomic< quint64 > m_spilled;
+	std::atomic< int > m_write_errors;
+
+	template< typename F >
+	bool push_record(F fill);
+	/// records of the compressed log waiting for the block
+	QByteArray m_block;
+	int m_block_count;
+	qint64 m_block_first_tick;
+	QByteArray m_block_out;
+	QElapsedTimer m_block_timer;
+
+	/// path and the base name of files of the session without extension
+	QString m_session;
+	int m_chunk_number;
+	/// index of the current file
+	LogIndexChunk m_chunk;
+	int m_records_from_point;
+	/// last tick and count of records of the file passed to the writer
+	qint64 m_written_last_tick;
+	qint64 m_written_count;
+	/// count of records and points of the file in the provisional entry of the index
+	qint64 m_provisional_count;
+	int m_provisional_points;
+	QElapsedTimer m_chunk_timer;
+	std::atomic< qint64 > m_rotate_size;
+	std::atomic< int > m_rotate_duration;
+	/// time from the last submit of the partial block of the writer
+	QElapsedTimer m_flush_timer;
+	std::atomic< int > m_flush_interval;
+
+	/**
+	 * @brief write_pending
+	 * write the queue and the spill buffer. m_file_mutex must be locked
+	 * @param finish - write the partial block of the compressed log
+	 */
+	void write_pending(bool finish = false);
+	void write_spill();
+	/**
+	 * @brief put_record
+	 * write the record to the file or to the block of the compressed log
+	 * @return false if the record is not the telemetry of the compressed log and is discarded
+	 */
+	bool put_record(const char* data, int size, qint64 tick);
+	void write_block();
+	/// open the next file of the session
+	void open_chunk();
+	/// write the rest of the file and its entry of the index
+	void finish_chunk();
+	/// append the provisional entry of the open file after the flush if it has new records
+	void write_provisional();
+	bool need_rotate() const;
+	void open_file(const QString& name);
 };
 
 ////////////////////////////////////
 /// \brief The WriteLog class
-/// to control class of logs
+/// to control class of logs.
+/// the thread sleeps until records are pushed and writes them when
+/// the count of pending records reaches the batch threshold or the latency expires
 class WriteLog : public QThread
 {
+	Q_OBJECT
 public:
+	enum{ default_batch_records = 4096, default_max_latency = 100 };
+
 	WriteLog(QObject *parent = 0);
 	~WriteLog();
 
 	static WriteLog *instance();
+	/**
+	 * @brief release
+	 * stop the thread of the instance, write pending records, close logs and delete the instance
+	 */
+	static void release();
 
 	/**
 	 * @brief clearLogs
@@ -96,8 +301,87 @@ public:
 	 * @param data
 	 */
 	void write_data(const QString & name, const QVector< sc::StructTelemetry > &data);
+	/**
+	 * @brief write_data
+	 * write telemetry from any store to log with name
+	 * @param name
+	 * @param count - count of samples
+	 * @param sample - sample with index from [0, count)
+	 */
+	void write_data(const QString & name, int count, const std::function< sc::StructTelemetry (int) >& sample);
 	void closeLog(const QString& name);
+	/**
+	 * @brief set_telemetry_format
+	 * format for new logs of telemetry. csv stays available for export
+	 * @param format
+	 */
+	void set_telemetry_format(TelemetryFormat::Format format);
+	TelemetryFormat::Format telemetry_format() const;
+	/**
+	 * @brief set_queue_capacity
+	 * capacity of the queue for new logs
+	 * @param value
+	 */
+	void set_queue_capacity(int value);
+	int queue_capacity() const;
+	/**
+	 * @brief set_lossless
+	 * spill records to the secondary buffer when the queue is full
+	 * @param value
+	 */
+	void set_lossless(bool value);
+	bool is_lossless() const;
+	/**
+	 * @brief set_max_spill_size
+	 * @param value - maximum size of the spill buffer of each log in bytes
+	 */
+	void set_max_spill_size(int value);
+	int max_spill_size() const;
+	/**
+	 * @brief set_rotation
+	 * rotation of files of all logs
+	 * @param max_size - size of the file in MiB, 0 to disable
+	 * @param max_duration - duration of the file in seconds, 0 to disable
+	 */
+	void set_rotation(int max_size, int max_duration);
+	int rotate_size() const;
+	int rotate_duration() const;
+	/**
+	 * @brief set_flush_interval
+	 * interval of the submit of the partial block of the writer for all logs.
+	 * records younger than the interval are lost at the power cut, up to the interval of telemetry.
+	 * 0 submits after each write like the line-by-line log, but the disk gets many small unaligned writes,
+	 * large values keep writes large for slow cards
+	 * @param value - interval in ms
+	 */
+	void set_flush_interval(int value);
+	int flush_interval() const;
+	/**
+	 * @brief statistic
+	 * counters of all logs
+	 * @return
+	 */
+	QList< LogStatistic > statistic();
+	/**
+	 * @brief set_flush_thresholds
+	 * @param records - count of pending records to wake the writer
+	 * @param max_latency - maximum delay of the record in ms
+	 */
+	void set_flush_thresholds(int records, int max_latency);
+	int batch_records() const;
+	int max_latency() const;
+	/**
+	 * @brief stop
+	 * finish the thread after the write of pending records
+	 */
+	void stop();
 signals:
+	/**
+	 * @brief add_to_log
+	 * warning about lost records
+	 * @param text
+	 */
+	void add_to_log(const QString& text);
 
 public slots:
 	void _on_timeout();
@@ -106,8 +390,46 @@ protected:
 	virtual void run();
 
 private:
-	QMap< QString, LogFile > m_logFiles;
+	QMap< QString, LogFile* > m_logFiles;
+	QReadWriteLock m_lock_logs;
 	bool m_write_log;
+	TelemetryFormat::Format m_telemetry_format;
+	int m_queue_capacity;
+	bool m_lossless;
+	int m_max_spill_size;
+	int m_rotate_size;
+	int m_rotate_duration;
+	int m_flush_interval;
+	/// count of dropped records of each log at the last check
+	QMap< QString, quint64 > m_reported_dropped;
+	QMap< QString, int > m_reported_errors;
+
+	QMutex m_wait_mutex;
+	QWaitCondition m_wait_cond;
+	/// records pushed after the last write
+	std::atomic< int > m_pending;
+	std::atomic< int > m_batch_records;
+	std::atomic< int > m_max_latency;
+	std::atomic< bool > m_stop;
+
+	/**
+	 * @brief notify_writer
+	 * count the pushed record and wake the writer at the first record and at the batch threshold
+	 */
+	void notify_writer();
+	/**
+	 * @brief wait_records
+	 * sleep until the batch threshold or the latency after the first record
+	 */
+	void wait_records();
+
+	/**
+	 * @brief log_file
+	 * find or create the log with name
+	 * @param name
+	 * @return
+	 */
+	LogFile* log_file(const QString& name);
 
 	static WriteLog *m_instance;
 };
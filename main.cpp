@@ -5,6 +5,9 @@
 
 #include "time.h"
 
+#include "writelog.h"
+#include "loganalyzer.h"
+
 /// @test code
 int test_matrix()
 {
@@ -95,9 +98,26 @@ int main(int argc, char *argv[])
 {
 	//test_matrix();
 
+	/// headless analysis of logs without the window
+	for(int i = 1; i < argc; i++){
+		if(QString(argv[i]) == "--analyze"){
+			QCoreApplication app(argc, argv);
+			return LogAnalyzer::exec(app.arguments());
+		}
+	}
+
 	QApplication a(argc, argv);
-	MainWindow w;
-	w.show();
 
-	return a.exec();
+	int res;
+	{
+		MainWindow w;
+		w.show();
+
+		res = a.exec();
+	}
+
+	/// sources of records are destroyed with the window
+	WriteLog::release();
+
+	return res;
 }
@@ -6,6 +6,7 @@
 #include <QFileDialog>
 #include "QListWidgetItem"
 #include <QLabel>
+#include <QTime>
 
 #include <global.h>
 #include <simple_xml.hpp>
@@ -49,6 +50,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
 	connect(ui->gyrodata->model(), SIGNAL(add_to_log(QString)), this, SLOT(add_to_log(QString)));
 	connect(ui->gyrodata->model()->sensorsWork(), SIGNAL(add_to_log(QString)), this, SLOT(add_to_log(QString)));
+	connect(WriteLog::instance(), SIGNAL(add_to_log(QString)), this, SLOT(add_to_log(QString)));
 	connect(ui->gyrodata->model(), SIGNAL(set_text(QString,QString)), m_dataShow, SLOT(set_text(QString,QString)));
 	connect(ui->gyrodata->model()->sensorsWork(), SIGNAL(set_text(QString,QString)), m_dataShow, SLOT(set_text(QString,QString)));
 
@@ -107,6 +109,25 @@ void MainWindow::load_from_xml()
 	ui->gyrodata->set_enable(sxml["gyrodata"]);
 
 	ui->tw_settings->setCurrentIndex(sxml["tab_index"]);
+
+	bool log_csv = sxml["telemetry_log_csv"];
+	ui->actionTelemetry_log_CSV->setChecked(log_csv);
+	bool log_compressed = sxml["telemetry_log_compressed"];
+	ui->actionTelemetry_log_compressed->setChecked(log_compressed);
+	update_telemetry_format();
+
+	if(!sxml["log_queue_capacity"].empty())
+		WriteLog::instance()->set_queue_capacity(sxml["log_queue_capacity"]);
+	if(!sxml["log_lossless"].empty())
+		WriteLog::instance()->set_lossless(sxml["log_lossless"]);
+	if(!sxml["log_max_spill_size"].empty())
+		WriteLog::instance()->set_max_spill_size(sxml["log_max_spill_size"]);
+	if(!sxml["log_batch_records"].empty() && !sxml["log_max_latency"].empty())
+		WriteLog::instance()->set_flush_thresholds(sxml["log_batch_records"], sxml["log_max_latency"]);
+	if(!sxml["log_rotate_size"].empty() && !sxml["log_rotate_duration"].empty())
+		WriteLog::instance()->set_rotation(sxml["log_rotate_size"], sxml["log_rotate_duration"]);
+	if(!sxml["log_flush_interval"].empty())
+		WriteLog::instance()->set_flush_interval(sxml["log_flush_interval"]);
 }
 
 void MainWindow::save_to_xml()
@@ -127,6 +148,16 @@ void MainWindow::save_to_xml()
 	sxml << "quadmodel" << ui->quadmodel->is_enable();
 	sxml << "gyrodata" << ui->gyrodata->is_enable();
 	sxml << "tab_index" << ui->tw_settings->currentIndex();
+	sxml << "telemetry_log_csv" << ui->actionTelemetry_log_CSV->isChecked();
+	sxml << "telemetry_log_compressed" << ui->actionTelemetry_log_compressed->isChecked();
+	sxml << "log_queue_capacity" << WriteLog::instance()->queue_capacity();
+	sxml << "log_lossless" << WriteLog::instance()->is_lossless();
+	sxml << "log_max_spill_size" << WriteLog::instance()->max_spill_size();
+	sxml << "log_batch_records" << WriteLog::instance()->batch_records();
+	sxml << "log_max_latency" << WriteLog::instance()->max_latency();
+	sxml << "log_rotate_size" << WriteLog::instance()->rotate_size();
+	sxml << "log_rotate_duration" << WriteLog::instance()->rotate_duration();
+	sxml << "log_flush_interval" << WriteLog::instance()->flush_interval();
 
 }
 
@@ -214,3 +245,27 @@ void MainWindow::on_actionSave_to_Log_triggered(bool checked)
 {
 	WriteLog::instance()->set_write_log(checked);
 }
+
+void MainWindow::on_actionTelemetry_log_CSV_triggered(bool checked)
+{
+	Q_UNUSED(checked);
+	update_telemetry_format();
+}
+
+void MainWindow::on_actionTelemetry_log_compressed_triggered(bool checked)
+{
+	Q_UNUSED(checked);
+	update_telemetry_format();
+}
+
+void MainWindow::update_telemetry_format()
+{
+	TelemetryFormat::Format format = TelemetryFormat::Binary;
+	if(ui->actionTelemetry_log_CSV->isChecked())
+		format = TelemetryFormat::CSV;
+	else if(ui->actionTelemetry_log_compressed->isChecked())
+		format = TelemetryFormat::Compressed;
+
+	WriteLog::instance()->set_telemetry_format(format);
+	ui->actionTelemetry_log_compressed->setEnabled(!ui->actionTelemetry_log_CSV->isChecked());
+}
@@ -41,8 +41,17 @@ private slots:
 
 	void on_actionSave_to_Log_triggered(bool checked);
 
+	void on_actionTelemetry_log_CSV_triggered(bool checked);
+
+	void on_actionTelemetry_log_compressed_triggered(bool checked);
+
 protected:
 	void init_list_objects();
+	/**
+	 * @brief update_telemetry_format
+	 * format of new logs of telemetry from actions of the menu
+	 */
+	void update_telemetry_format();
 
 private:
 	Ui::MainWindow *ui;
@@ -103,6 +103,7 @@ void get_lever_axes(const QVector3D* v, QVector3D *vv)
 
 QuadModel::QuadModel(QObject *parent):
 	VirtGLObject(parent)
+  , m_mutex(QMutex::Recursive)
   , m_is_draw_lever(true)
 {
 	setType(QUADMODEL);
@@ -131,11 +132,7 @@ QuadModel::QuadModel(QObject *parent):
 #endif
 
 	m_delta_time = delta_time;
-	m_time_noise.start();
-	m_time_noise_start = m_time_noise.elapsed();
-
-	connect(&m_timer_noise, SIGNAL(timeout()), this, SLOT(_on_timeout_noise()));
-	m_timer_noise.start(10);
+	m_time_noise = 0;
 
 	generate_engines_rnd();
 
@@ -179,16 +176,19 @@ void QuadModel::saveXml()
 
 double QuadModel::lever() const
 {
+	QMutexLocker lock(&m_mutex);
 	return m_lever;
 }
 
 void QuadModel::setLever(double value)
 {
+	QMutexLocker lock(&m_mutex);
 	m_lever = value;
 }
 
 double QuadModel::power() const
 {
+	QMutexLocker lock(&m_mutex);
 	double pw = 0;
 	for(int i = 0; i < 4; i++){
 		pw += m_engines[i] + m_engines_rnd[i];
@@ -198,6 +198,7 @@ double QuadModel::power() const
 
 double QuadModel::real_power() const
 {
+	QMutexLocker lock(&m_mutex);
 	double pw = 0;
 	for(int i = 0; i < 4; i++){
 		pw += m_engines[i];
@@ -208,6 +209,7 @@ double QuadModel::real_power() const
 
 void QuadModel::reset()
 {
+	QMutexLocker lock(&m_mutex);
 	m_normal = normal_begin;
 	m_course = course_begin;
 	m_rot_speed = 0;
@@ -220,11 +222,13 @@ void QuadModel::reset()
 
 void QuadModel::reset_power()
 {
+	QMutexLocker lock(&m_mutex);
 	for(int i = 0; i < 4; i++) m_engines[i] = 0;
 }
 
 void QuadModel::set_distribution_parameters(double mean, double sigma)
 {
+	QMutexLocker lock(&m_mutex);
 #if (_MSC_VER >= 1500 && _MSC_VER <= 1600)
 	distribution = std::tr1::normal_distribution<double>(mean, sigma);
 #else
@@ -243,13 +247,21 @@ void QuadModel::set_draw_telemetry(bool value)
 	m_is_draw_telemetry = value;
 }
 
+double QuadModel::engines(int index) const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_engines[index];
+}
+
 double QuadModel::engines_noise(int index)
 {
+	QMutexLocker lock(&m_mutex);
 	return qMax(0.0, m_engines[index] + m_engines_rnd[index]);
 }
 
 void QuadModel::add_power(double value)
 {
+	QMutexLocker lock(&m_mutex);
 	for(int i = 0; i < 4; i++){
 		m_engines[i] += value;
 		if(m_engines[i] > m_max_power){
@@ -262,6 +274,7 @@ void QuadModel::add_power(double value)
 
 void QuadModel::add_power(int index, double value)
 {
+	QMutexLocker lock(&m_mutex);
 	m_engines[index] += value;
 	if(m_engines[index] < 0)
 		m_engines[index] = 0;
@@ -271,6 +284,7 @@ void QuadModel::add_power(int index, double value)
 
 void QuadModel::set_power(double value)
 {
+	QMutexLocker lock(&m_mutex);
 	for(int i = 0; i < 4; i++){
 		m_engines[i] = value + m_engines_rnd[i];
 		if(m_engines[i] > m_max_power){
@@ -293,21 +307,25 @@ QColor QuadModel::color() const
 
 void QuadModel::set_koeff_fade(double value)
 {
+	QMutexLocker lock(&m_mutex);
 	m_koeff_fade = value;
 }
 
 double QuadModel::koeff_fade() const
 {
+	QMutexLocker lock(&m_mutex);
 	return m_koeff_fade;
 }
 
 void QuadModel::setControl(const StructControls &control)
 {
+	QMutexLocker lock(&m_mutex);
 	m_controls = control;
 }
 
 StructTelemetry QuadModel::telemetry() const
 {
+	QMutexLocker lock(&m_mutex);
 	return m_telemetry;
 }
 
@@ -332,15 +350,15 @@ void QuadModel::draw()
 	glPushMatrix();
 	glLineWidth(3);
 
-	glTranslated(m_position.x(), m_position.y(), m_position.z());
+	glTranslated(m_draw.position.x(), m_draw.position.y(), m_draw.position.z());
 
 	draw_vect(normal_begin, Z0, Qt::yellow);
 	draw_vect(course_begin, Z0, Qt::darkCyan);
 
 	mat_type vals[] = {
-		m_tmp_vc2.x(), m_tmp_vc2.y(), m_tmp_vc2.z(), 0,
-		m_tmp_course.x(), m_tmp_course.y(), m_tmp_course.z(), 0,
-		m_tmp_normal.x(), m_tmp_normal.y(), m_tmp_normal.z(), 0,
+		m_draw.tmp_vc2.x(), m_draw.tmp_vc2.y(), m_draw.tmp_vc2.z(), 0,
+		m_draw.tmp_course.x(), m_draw.tmp_course.y(), m_draw.tmp_course.z(), 0,
+		m_draw.tmp_normal.x(), m_draw.tmp_normal.y(), m_draw.tmp_normal.z(), 0,
 		0, 0, 0, 1
 	};
 
@@ -427,7 +445,7 @@ void QuadModel::draw()
 	glPointSize(4);
 	glColor3f(1, 0, 0);
 	glBegin(GL_POINTS);
-	foreach (QVector3D pt, m_trajectory) {
+	foreach (QVector3D pt, m_draw.trajectory) {
 		glVertex3d(pt.x(), pt.y(), pt.z());
 	}
 	glEnd();
@@ -443,21 +461,38 @@ void QuadModel::draw()
 
 void QuadModel::tick()
 {
+	/// the latest state of the simulation for the frame
+	QMutexLocker lock(&m_mutex);
+	m_draw.position = m_position;
+	m_draw.tmp_normal = m_tmp_normal;
+	m_draw.tmp_course = m_tmp_course;
+	m_draw.tmp_vc2 = m_tmp_vc2;
+	for(int i = 0; i < 4; i++){
+		m_draw.tmp_n[i] = m_tmp_n[i];
+	}
+	m_draw.trajectory = m_trajectory;
+}
+
+void QuadModel::step(double dt)
+{
+	/// the trajectory is integrated once per the fixed step of SimulationClock, dt moves the noise only
+	QMutexLocker lock(&m_mutex);
+	calc_noise(dt);
 	calc_trajectory();
 }
 
 QVector3D QuadModel::position() const
 {
-	return m_position;
+	return m_draw.position;
 }
 
-void QuadModel::_on_timeout_noise()
+void QuadModel::calc_noise(double dt)
 {
-	double delta = m_time_noise.elapsed() - m_time_noise_start;
+	m_time_noise += dt;
+	double delta = m_time_noise;
 	if(delta > m_delta_time){
 		delta = 0;
-		m_time_noise.restart();
-		m_time_noise_start = m_time_noise.elapsed();
+		m_time_noise = 0;
 		m_delta_time = delta_time + distribution_time(generator);
 
 		change_engines_rnd();
@@ -606,9 +641,9 @@ void QuadModel::draw_tmp_struct()
 {
 	glLineWidth(5);
 
-	draw_vect(m_tmp_normal, Z0, QC(0.7f, 1.f, 0.3f));
-	draw_vect(m_tmp_vc2, Z0, QC(1.f, 0.3f, 0.3f));
-	draw_vect(m_tmp_course, Z0, QC(0.3f, 0.3f, 1.f));
+	draw_vect(m_draw.tmp_normal, Z0, QC(0.7f, 1.f, 0.3f));
+	draw_vect(m_draw.tmp_vc2, Z0, QC(1.f, 0.3f, 0.3f));
+	draw_vect(m_draw.tmp_course, Z0, QC(0.3f, 0.3f, 1.f));
 
 	glLineWidth(3);
 
@@ -618,11 +653,11 @@ void QuadModel::draw_tmp_struct()
 //	}
 
 	QVector3D v[4];
-	get_vec_levers(m_tmp_course, m_tmp_normal, m_lever, v);
+	get_vec_levers(m_draw.tmp_course, m_draw.tmp_normal, m_lever, v);
 
 	glColor3f(0.f, 0.3f, 1.f);
 	for(int i = 0; i < 4; i++){
-		draw_vect(m_tmp_n[i], v[i], QC(0.f, 0.3f, 1.f));
+		draw_vect(m_draw.tmp_n[i], v[i], QC(0.f, 0.3f, 1.f));
 	}
 
 
@@ -686,15 +721,15 @@ void QuadModel::draw_telemetry()
 	}
 	glEnd();
 
-	QVector3D tmp_vc2_z0 = m_tmp_vc2;
+	QVector3D tmp_vc2_z0 = m_draw.tmp_vc2;
 	tmp_vc2_z0.setZ(0);
 
-	QVector3D nc = m_tmp_course;
+	QVector3D nc = m_draw.tmp_course;
 	nc.setZ(0);
 
-	QVector3D v1 = QVector3D::crossProduct(normal_begin, m_tmp_course);
+	QVector3D v1 = QVector3D::crossProduct(normal_begin, m_draw.tmp_course);
 
-	double d = QVector3D::dotProduct(m_tmp_vc2, v1);
+	double d = QVector3D::dotProduct(m_draw.tmp_vc2, v1);
 	double d1 = 0;
 
 //	if(m_tmp_normal.z() < 0){
@@ -714,13 +749,13 @@ void QuadModel::draw_telemetry()
 		lc = -lc;
 	}
 
-	QVector3D vl = QVector3D(l, m_tmp_vc2.z(), 0).normalized() * R;
+	QVector3D vl = QVector3D(l, m_draw.tmp_vc2.z(), 0).normalized() * R;
 
 	QVector3D vp = QVector3D(vl.y(), -vl.x(), 0).normalized();
 
 	double offset_course = 0;
 	{
-		QVector3D vc = QVector3D(lc, m_tmp_course.z(), 0).normalized() * R;
+		QVector3D vc = QVector3D(lc, m_draw.tmp_course.z(), 0).normalized() * R;
 		vc.setX(0);
 		double l = vc.y();
 		offset_course = l;
@@ -799,7 +834,7 @@ void QuadModel::draw_telemetry()
 	glPopMatrix();
 
 	draw_vect(tmp_vc2_z0, Z0);
-	draw_vect(QVector3D(0, 0, m_tmp_vc2.z()), tmp_vc2_z0);
+	draw_vect(QVector3D(0, 0, m_draw.tmp_vc2.z()), tmp_vc2_z0);
 }
 
 void QuadModel::draw_transp_plane(const QMatrix4x4 &matrix, const QColor &c)
@@ -5,7 +5,7 @@
 #include <QVector>
 #include <QPointF>
 #include <QTimer>
-#include <QTime>
+#include <QMutex>
 #include <QQuaternion>
 #include <QColor>
 #include <QWidget>
@@ -95,7 +95,7 @@ public:
 	 * @param index
 	 * @return
 	 */
-	double engines(int index) const {return m_engines[index]; }
+	double engines(int index) const;
 	/**
 	 * @brief engines_noise
 	 * return power of engines with noise
@@ -175,16 +175,29 @@ public:
 	virtual void init();
 	virtual void draw();
 	virtual void tick();
+	virtual void step(double dt);
 	virtual QVector3D position() const;
 
-public slots:
-	void _on_timeout_noise();
-
 protected:
 	void loadXml();
 	void saveXml();
 
 private:
+	/**
+	 * @brief The DrawState struct
+	 * state of the model for drawing, taken from the simulation before each frame
+	 */
+	struct DrawState{
+		QVector3D position;
+		QVector3D tmp_n[4];
+		QVector3D tmp_normal, tmp_course, tmp_vc2;
+		QVector< QVector3D > trajectory;
+	};
+
+	/// guards the state of the simulation, it is changed in the thread of SimulationClock
+	mutable QMutex m_mutex;
+	DrawState m_draw;
+
 	double m_lever;
 	double m_mg;
 	double m_max_power;
@@ -204,9 +217,8 @@ private:
 	double m_rot_speed;
 	double m_koeff_fade;
 
-	QTimer m_timer_noise;
-	QTime m_time_noise;
-	int m_time_noise_start;
+	/// time of the simulation from the last change of the noise, ms
+	double m_time_noise;
 	int m_delta_time;
 
 	sc::StructControls m_controls;
@@ -241,6 +253,7 @@ private:
 	void generate_engines_rnd();
 	void calc_engines_rnd(double delta);
 	void change_engines_rnd();
+	void calc_noise(double dt);
 
 	void calc_trajectory();
 
@@ -0,0 +1,119 @@
+#include "asynclogloader.h"
+
+#include <QStringList>
+
+#include "logindex.h"
+
+AsyncLogLoader::AsyncLogLoader(QObject *parent)
+	: QThread(parent)
+	, m_cancel(false)
+	, m_file_index(0)
+	, m_file_count(1)
+{
+}
+
+AsyncLogLoader::~AsyncLogLoader()
+{
+	cancel();
+}
+
+void AsyncLogLoader::load(const QString &fileName)
+{
+	cancel();
+
+	m_fileName = fileName;
+	m_error.clear();
+	m_cancel = false;
+	m_file_index = 0;
+	m_file_count = 1;
+	m_ready.clear();
+
+	start();
+}
+
+void AsyncLogLoader::cancel()
+{
+	m_cancel = true;
+	m_loader.cancel();
+	wait();
+
+	QMutexLocker lock(&m_mutex);
+	m_ready.clear();
+}
+
+bool AsyncLogLoader::is_loading() const
+{
+	return isRunning();
+}
+
+bool AsyncLogLoader::is_cancelled() const
+{
+	return m_cancel;
+}
+
+double AsyncLogLoader::progress() const
+{
+	return (m_file_index + m_loader.progress()) / qMax(1, (int)m_file_count);
+}
+
+int AsyncLogLoader::take(TelemetryColumns &dst)
+{
+	QMutexLocker lock(&m_mutex);
+	int count = m_ready.size();
+	if(count){
+		dst += m_ready;
+		m_ready.clear();
+	}
+	return count;
+}
+
+QString AsyncLogLoader::error() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_error;
+}
+
+QString AsyncLogLoader::fileName() const
+{
+	return m_fileName;
+}
+
+void AsyncLogLoader::run()
+{
+	QStringList files;
+	if(m_fileName.endsWith(LogIndex::extension())){
+		LogIndex index;
+		if(!index.load(m_fileName)){
+			QMutexLocker lock(&m_mutex);
+			m_error = "empty index of the session";
+			return;
+		}
+		for(int i = 0; i < index.chunks().size(); i++){
+			files.push_back(index.chunk_path(i));
+		}
+	}else{
+		files.push_back(m_fileName);
+	}
+	m_file_count = files.size();
+
+	bool res = true;
+	QString error;
+	for(int i = 0; i < files.size() && res && !m_cancel; i++){
+		m_file_index = i;
+		res = m_loader.load(files[i], [this](TelemetryColumns& part){
+			/// the cancel before the start of the load is not seen by the loader
+			if(m_cancel){
+				m_loader.cancel();
+				return;
+			}
+			QMutexLocker lock(&m_mutex);
+			m_ready += part;
+		});
+		if(!res)
+			error = files.size() > 1? files[i] + ": " + m_loader.error() : m_loader.error();
+	}
+
+	QMutexLocker lock(&m_mutex);
+	if(!res)
+		m_error = m_cancel? QString("cancelled") : error;
+}
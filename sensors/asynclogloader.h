@@ -0,0 +1,75 @@
+#ifndef ASYNCLOGLOADER_H
+#define ASYNCLOGLOADER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+
+#include "telemetryloader.h"
+#include "telemetrycolumns.h"
+
+/**
+ * @brief The AsyncLogLoader class
+ * load of the log in the background thread. parsed parts are collected in order
+ * and taken by the gui thread while the rest of the log is parsed,
+ * so the data is shown progressively. finished() of the thread is emitted at the end.
+ * the index of the session is loaded by its files one after another
+ */
+class AsyncLogLoader : public QThread
+{
+public:
+	explicit AsyncLogLoader(QObject* parent = 0);
+	~AsyncLogLoader();
+
+	/**
+	 * @brief load
+	 * cancel the current load and start the new one
+	 * @param fileName - log or the index of the session
+	 */
+	void load(const QString& fileName);
+	/**
+	 * @brief cancel
+	 * stop the load and wait for the thread. parts that are not taken are dropped
+	 */
+	void cancel();
+	bool is_loading() const;
+	bool is_cancelled() const;
+	/**
+	 * @brief progress
+	 * @return part of the parsed file [0, 1]
+	 */
+	double progress() const;
+	/**
+	 * @brief take
+	 * append parts parsed after the previous call
+	 * @param dst
+	 * @return count of appended samples
+	 */
+	int take(TelemetryColumns& dst);
+	/**
+	 * @brief error
+	 * @return empty if the last load is successful
+	 */
+	QString error() const;
+	QString fileName() const;
+
+protected:
+	virtual void run();
+
+private:
+	TelemetryLoader m_loader;
+	QString m_fileName;
+	QString m_error;
+	std::atomic< bool > m_cancel;
+	/// file of the session in the load and count of files
+	std::atomic< int > m_file_index;
+	std::atomic< int > m_file_count;
+
+	mutable QMutex m_mutex;
+	/// parsed and not taken parts
+	TelemetryColumns m_ready;
+};
+
+#endif // ASYNCLOGLOADER_H
@@ -1,6 +1,10 @@
 #include "calibrateaccelerometer.h"
 #include <QDebug>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace sc;
 using namespace vector3_;
 
@@ -9,9 +13,10 @@ CalibrateAccelerometer::CalibrateAccelerometer(QObject *parent) :
   , m_max_pass(100)
   , m_pass(0)
   , m_pass_part_evaluate(0)
+  , m_percent_deviation(0.12)
   , m_state(none)
+  , m_cancel(false)
   , m_threshold(1e-6)
-  , m_percent_deviation(0.12)
 {
 }
 
@@ -27,7 +32,7 @@ bool CalibrateAccelerometer::is_done() const
 
 bool CalibrateAccelerometer::is_progress() const
 {
-	return m_state != none && m_state != end;
+	return m_state != none && m_state != end && m_state != cancelled;
 }
 
 int CalibrateAccelerometer::pass() const
@@ -50,6 +55,16 @@ StructMeanSphere CalibrateAccelerometer::result() const
 	return m_result;
 }
 
+void CalibrateAccelerometer::cancel()
+{
+	m_cancel = true;
+}
+
+bool CalibrateAccelerometer::is_cancelled() const
+{
+	return m_cancel;
+}
+
 bool CalibrateAccelerometer::set_parameters(const QVector<StructTelemetry> *sts, int max_pass, double threshold, double percent_deviation)
 {
 	if(is_progress())
@@ -62,6 +77,7 @@ bool CalibrateAccelerometer::set_parameters(const QVector<StructTelemetry> *sts,
 	m_max_pass = max_pass;
 	m_threshold = threshold;
 	m_state = none;
+	m_cancel = false;
 	m_percent_deviation = percent_deviation / 100.;
 
 	return true;
@@ -77,6 +93,7 @@ bool CalibrateAccelerometer::set_parameters(const QVector<Vector3d> &sts, int ma
 	m_max_pass = max_pass;
 	m_threshold = threshold;
 	m_state = none;
+	m_cancel = false;
 	m_percent_deviation = percent_deviation / 100.;
 
 	return true;
@@ -98,6 +115,15 @@ void CalibrateAccelerometer::evaluate()
 
 	m_state = begin;
 
+	m_xs.resize(m_analyze_data.size());
+	m_ys.resize(m_analyze_data.size());
+	m_zs.resize(m_analyze_data.size());
+	for(int i = 0; i < m_analyze_data.size(); i++){
+		m_xs[i] = m_analyze_data[i].x();
+		m_ys[i] = m_analyze_data[i].y();
+		m_zs[i] = m_analyze_data[i].z();
+	}
+
 	StructMeanSphere sphere;
 
 	bool loop = true;
@@ -107,7 +133,11 @@ void CalibrateAccelerometer::evaluate()
 
 		m_state = newpass;
 
-		StructMeanSphere p = circumscribed_sphere_search(m_analyze_data, p1, p2, dx, dy, dz);
+		StructMeanSphere p = circumscribed_sphere_search(p1, p2, dx, dy, dz);
+		if(m_cancel){
+			m_state = cancelled;
+			return;
+		}
 		double delta = qAbs(p.deviation - sphere.deviation);
 		if(delta < m_threshold){
 			loop = false;
@@ -157,36 +187,99 @@ bool CalibrateAccelerometer::search_minmax(const QVector< Vector3d >& data, Vect
 	 return true;
 }
 
-void CalibrateAccelerometer::calc_radius(const QVector< Vector3d >& sts, const Vector3d& p, StructMeanSphere& sp)
+/**
+ * @brief sum_radius
+ * sums of (r - shift) and (r - shift)^2 where r is the distance from (px, py, pz).
+ * the shift is close to the mean radius and keeps the variance without cancellation
+ */
+static inline void sum_radius(const double* xs, const double* ys, const double* zs, int count,
+							  double px, double py, double pz, double shift, double& s1, double& s2)
+{
+	int i = 0;
+	double sum1 = 0, sum2 = 0;
+
+#ifdef __SSE2__
+	__m128d vpx = _mm_set1_pd(px), vpy = _mm_set1_pd(py), vpz = _mm_set1_pd(pz);
+	__m128d vshift = _mm_set1_pd(shift);
+	__m128d acc1 = _mm_setzero_pd(), acc2 = _mm_setzero_pd();
+	for(; i + 2 <= count; i += 2){
+		__m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), vpx);
+		__m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), vpy);
+		__m128d dz = _mm_sub_pd(_mm_loadu_pd(zs + i), vpz);
+		__m128d r2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+		__m128d d = _mm_sub_pd(_mm_sqrt_pd(r2), vshift);
+		acc1 = _mm_add_pd(acc1, d);
+		acc2 = _mm_add_pd(acc2, _mm_mul_pd(d, d));
+	}
+	double a1[2], a2[2];
+	_mm_storeu_pd(a1, acc1);
+	_mm_storeu_pd(a2, acc2);
+	sum1 = a1[0] + a1[1];
+	sum2 = a2[0] + a2[1];
+#endif
+
+	for(; i < count; i++){
+		double dx = xs[i] - px, dy = ys[i] - py, dz = zs[i] - pz;
+		double d = sqrt(dx * dx + dy * dy + dz * dz) - shift;
+		sum1 += d;
+		sum2 += d * d;
+	}
+
+	s1 = sum1;
+	s2 = sum2;
+}
+
+void CalibrateAccelerometer::calc_radius(const Vector3d& p, StructMeanSphere& sp)
 {
 	m_state = evaluate_mean_radius;
 
 	sp.cp = p;
-	QVector< double > radiuses;
-	for(int i = 0; i < sts.size(); i++) {
-		Vector3d ad(sts[i]);
-		ad -= p;
-		radiuses.push_back(ad.length());
-	}
-	double sum = 0;
-	foreach (double r, radiuses) {
-		sum += r;
+
+	int count = m_xs.size();
+	if(!count){
+		sp.mean_radius = 0;
+		sp.deviation = 0;
+		return;
 	}
-	sum /= radiuses.size();
 
-	m_state = evaluate_deviation;
+	double dx = m_xs[0] - p.x(), dy = m_ys[0] - p.y(), dz = m_zs[0] - p.z();
+	double shift = sqrt(dx * dx + dy * dy + dz * dz);
+
+	double s1, s2;
+	sum_radius(m_xs.constData(), m_ys.constData(), m_zs.constData(), count, p.x(), p.y(), p.z(), shift, s1, s2);
+
+	double mean = s1 / count;
+	double deviation = s2 / count - mean * mean;
 
-	double deviation = 0;
-	foreach (double r, radiuses) {
-		deviation += (r - sum) * (r - sum);
+	sp.mean_radius = shift + mean;
+	sp.deviation = sqrt(qMax(0., deviation));
+}
+
+int CalibrateAccelerometer::remove_outliers(const StructMeanSphere &sp)
+{
+	const double max_delta = m_percent_deviation * sp.mean_radius;
+
+	int j = 0;
+	for(int i = 0; i < m_xs.size(); i++){
+		double dx = m_xs[i] - sp.cp.x(), dy = m_ys[i] - sp.cp.y(), dz = m_zs[i] - sp.cp.z();
+		double r = sqrt(dx * dx + dy * dy + dz * dz);
+		if(fabs(r - sp.mean_radius) > max_delta)
+			continue;
+		m_xs[j] = m_xs[i];
+		m_ys[j] = m_ys[i];
+		m_zs[j] = m_zs[i];
+		j++;
 	}
-	deviation /= radiuses.size();
 
-	sp.mean_radius = sum;
-	sp.deviation = sqrt(deviation);
+	int removed = m_xs.size() - j;
+	m_xs.resize(j);
+	m_ys.resize(j);
+	m_zs.resize(j);
+
+	return removed;
 }
 
-StructMeanSphere CalibrateAccelerometer::circumscribed_sphere_search(QVector< Vector3d >& sts, const Vector3d& p1, const Vector3d& p2,
+StructMeanSphere CalibrateAccelerometer::circumscribed_sphere_search(const Vector3d& p1, const Vector3d& p2,
 											 double& dx, double& dy, double& dz)
 {
 	const int count_side = 10;
@@ -213,7 +306,9 @@ StructMeanSphere CalibrateAccelerometer::circumscribed_sphere_search(QVector< Ve
 			for(int j = 0; j < count_side; j++){
 				p.setX(p1.x());
 				for(int k = 0; k < count_side; k++, l++){
-					calc_radius(sts, p, pts[l]);
+					if(m_cancel)
+						return res;
+					calc_radius(p, pts[l]);
 					p.setX(p.x() + dx);
 
 					m_pass_part_evaluate = (double) l / pts.size();
@@ -233,17 +328,11 @@ StructMeanSphere CalibrateAccelerometer::circumscribed_sphere_search(QVector< Ve
 		}
 
 		res = pts[sid];
-		int all = sts.size();
-		for(int j = 0; j < sts.size(); j++){
-			Vector3d rd = Vector3d(sts[j]) - pts[sid].cp;
-			if(fabs(rd.length() - pts[sid].mean_radius) > m_percent_deviation * pts[sid].mean_radius){
-				deviat_great_cnt++;
-				sts.remove(j);
-			}
-		}
+		int all = m_xs.size();
+		deviat_great_cnt = remove_outliers(res);
 		QString debug = QString("calibrate: outlers=%1; count=%2; previous_count=%3")
 				.arg(deviat_great_cnt)
-				.arg(sts.size())
+				.arg(m_xs.size())
 				.arg(all);
 		qDebug() << debug;
 		emit send_log(debug);
@@ -253,15 +342,3 @@ StructMeanSphere CalibrateAccelerometer::circumscribed_sphere_search(QVector< Ve
 	return res;
 }
 
-/////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////
-
-CalibrateAccelerometerRunnable::CalibrateAccelerometerRunnable(CalibrateAccelerometer *calibrate)
-{
-	m_calibrate = calibrate;
-}
-
-void CalibrateAccelerometerRunnable::run()
-{
-	m_calibrate->evaluate();
-}
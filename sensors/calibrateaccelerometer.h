@@ -1,9 +1,11 @@
 #ifndef CALIBRATEACCELEROMETER_H
 #define CALIBRATEACCELEROMETER_H
 
-#include <QRunnable>
+#include <QObject>
 #include <QVector>
 
+#include <atomic>
+
 #include "struct_controls.h"
 
 /**
@@ -43,7 +45,8 @@ public:
 		evaluate_mean_radius,
 		evaluate_deviation,
 		search_min_box,
-		end
+		end,
+		cancelled
 	};
 
 	explicit CalibrateAccelerometer(QObject *parent = 0);
@@ -56,6 +59,12 @@ public:
 	double threshold() const;
 	StructMeanSphere result() const;
 	void evaluate();
+	/**
+	 * @brief cancel
+	 * stop evaluate as soon as possible. may be called from any thread
+	 */
+	void cancel();
+	bool is_cancelled() const;
 	/**
 	 * @brief set_parameters
 	 * @param sts
@@ -76,12 +85,17 @@ public slots:
 
 private:
 	QVector< vector3_::Vector3d > m_analyze_data;
+	/// structure of arrays of m_analyze_data for the radius kernel
+	QVector< double > m_xs;
+	QVector< double > m_ys;
+	QVector< double > m_zs;
 
 	int m_max_pass;
-	int m_pass;
-	double m_pass_part_evaluate;
+	std::atomic< int > m_pass;
+	std::atomic< double > m_pass_part_evaluate;
 	double m_percent_deviation;
-	STATE_EVALUATE m_state;
+	std::atomic< STATE_EVALUATE > m_state;
+	std::atomic< bool > m_cancel;
 	double m_threshold;
 	StructMeanSphere m_result;
 
@@ -95,26 +109,20 @@ private:
 	bool search_minmax(const QVector< vector3_::Vector3d >& data, vector3_::Vector3d &min, vector3_::Vector3d &max);
 	/**
 	 * @brief calc_radius
-	 * @param sts
+	 * mean radius and deviation from p for m_xs, m_ys, m_zs in one pass without allocations
 	 * @param p
 	 * @param sp
 	 */
-	void calc_radius(const QVector<vector3_::Vector3d> &sts, const vector3_::Vector3d& p, StructMeanSphere& sp);
-	StructMeanSphere circumscribed_sphere_search(QVector<vector3_::Vector3d> &sts, const vector3_::Vector3d& p1, const vector3_::Vector3d& p2,
+	void calc_radius(const vector3_::Vector3d& p, StructMeanSphere& sp);
+	StructMeanSphere circumscribed_sphere_search(const vector3_::Vector3d& p1, const vector3_::Vector3d& p2,
 												 double& dx, double& dy, double& dz);
-
-};
-
-////////////////////////////////////////////////////////
-
-class CalibrateAccelerometerRunnable: public QRunnable
-{
-public:
-	CalibrateAccelerometerRunnable(CalibrateAccelerometer *calibrate);
-protected:
-	virtual void run();
-private:
-	CalibrateAccelerometer *m_calibrate;
+	/**
+	 * @brief remove_outliers
+	 * remove points which deviate from the sphere more than m_percent_deviation
+	 * @param sp
+	 * @return count of removed points
+	 */
+	int remove_outliers(const StructMeanSphere& sp);
 
 };
 
@@ -0,0 +1,165 @@
+#include "calibrationjob.h"
+
+using namespace vector3_;
+
+CalibrationJob::CalibrationJob(int type)
+	: m_cancel(false)
+	, m_type(type)
+	, m_started(false)
+	, m_done(false)
+	, m_progress(0)
+{
+}
+
+CalibrationJob::~CalibrationJob()
+{
+}
+
+double CalibrationJob::progress() const
+{
+	return m_progress;
+}
+
+int CalibrationJob::pass() const
+{
+	return 0;
+}
+
+void CalibrationJob::cancel()
+{
+	m_cancel = true;
+}
+
+bool CalibrationJob::is_cancelled() const
+{
+	return m_cancel;
+}
+
+bool CalibrationJob::is_done() const
+{
+	return m_done;
+}
+
+bool CalibrationJob::is_progress() const
+{
+	return m_started && !m_done;
+}
+
+void CalibrationJob::set_callback(const CalibrationJob::callback_type &callback)
+{
+	m_callback = callback;
+}
+
+StructMeanSphere CalibrationJob::result() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_result;
+}
+
+void CalibrationJob::run()
+{
+	m_started = true;
+
+	if(!m_cancel)
+		evaluate();
+
+	m_done = true;
+
+	if(m_callback)
+		m_callback(this);
+}
+
+void CalibrationJob::set_progress(double value)
+{
+	m_progress = value;
+}
+
+void CalibrationJob::set_result(const StructMeanSphere &value)
+{
+	QMutexLocker lock(&m_mutex);
+	m_result = value;
+}
+
+////////////////////////////////////////////////////////
+
+SphereCalibrationJob::SphereCalibrationJob(int type, const QVector<Vector3d> &data)
+	: CalibrationJob(type)
+{
+	m_calibrate.set_parameters(data);
+}
+
+double SphereCalibrationJob::progress() const
+{
+	return m_calibrate.pass_part_evaluate();
+}
+
+int SphereCalibrationJob::pass() const
+{
+	return m_calibrate.pass();
+}
+
+void SphereCalibrationJob::cancel()
+{
+	CalibrationJob::cancel();
+	m_calibrate.cancel();
+}
+
+void SphereCalibrationJob::evaluate()
+{
+	m_calibrate.evaluate();
+
+	if(m_calibrate.is_done())
+		set_result(m_calibrate.result());
+}
+
+////////////////////////////////////////////////////////
+
+GyroBiasJob::GyroBiasJob(int type, const QVector<Vector3d> &data)
+	: CalibrationJob(type)
+	, m_data(data)
+{
+}
+
+void GyroBiasJob::evaluate()
+{
+	if(!m_data.size())
+		return;
+
+	Vector3d mean;
+	for(int i = 0; i < m_data.size() && !m_cancel; i++){
+		mean += m_data[i];
+	}
+	mean *= 1.0 / m_data.size();
+
+	set_progress(0.5);
+
+	double deviation = 0;
+	for(int i = 0; i < m_data.size() && !m_cancel; i++){
+		Vector3d d = m_data[i] - mean;
+		deviation += Vector3d::dot(d, d);
+	}
+	deviation /= m_data.size();
+
+	if(m_cancel)
+		return;
+
+	StructMeanSphere res;
+	res.cp = mean;
+	res.mean_radius = mean.length();
+	res.deviation = sqrt(deviation);
+	set_result(res);
+
+	set_progress(1);
+}
+
+////////////////////////////////////////////////////////
+
+CalibrationJobRunnable::CalibrationJobRunnable(const CalibrationJobPtr &job)
+	: m_job(job)
+{
+}
+
+void CalibrationJobRunnable::run()
+{
+	m_job->run();
+}
@@ -0,0 +1,135 @@
+#ifndef CALIBRATIONJOB_H
+#define CALIBRATIONJOB_H
+
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+#include "calibrateaccelerometer.h"
+
+/**
+ * @brief The CalibrationJob class
+ * one calibration running in a thread pool.
+ * progress, pass and state can be read from any thread
+ */
+class CalibrationJob
+{
+public:
+	typedef std::function< void (CalibrationJob* job) > callback_type;
+
+	explicit CalibrationJob(int type);
+	virtual ~CalibrationJob();
+
+	/**
+	 * @brief type
+	 * tag of the job set by the owner
+	 * @return
+	 */
+	int type() const { return m_type; }
+	/**
+	 * @brief progress
+	 * @return progress of the current pass [0, 1]
+	 */
+	virtual double progress() const;
+	virtual int pass() const;
+	/**
+	 * @brief cancel
+	 * request for stop. the callback is called anyway
+	 */
+	virtual void cancel();
+	bool is_cancelled() const;
+	bool is_done() const;
+	bool is_progress() const;
+	/**
+	 * @brief set_callback
+	 * the callback is called from the worker thread after evaluate
+	 * @param callback
+	 */
+	void set_callback(const callback_type& callback);
+	StructMeanSphere result() const;
+	/**
+	 * @brief run
+	 * evaluate and call the callback. use CalibrationJobRunnable for start it in a pool
+	 */
+	void run();
+
+protected:
+	virtual void evaluate() = 0;
+	void set_progress(double value);
+	void set_result(const StructMeanSphere& value);
+
+	std::atomic< bool > m_cancel;
+
+private:
+	int m_type;
+	std::atomic< bool > m_started;
+	std::atomic< bool > m_done;
+	std::atomic< double > m_progress;
+	callback_type m_callback;
+
+	mutable QMutex m_mutex;
+	StructMeanSphere m_result;
+};
+
+typedef QSharedPointer< CalibrationJob > CalibrationJobPtr;
+
+////////////////////////////////////////////////////////
+
+/**
+ * @brief The SphereCalibrationJob class
+ * search of the center of the sphere for accelerometer or compass
+ */
+class SphereCalibrationJob: public CalibrationJob
+{
+public:
+	SphereCalibrationJob(int type, const QVector< vector3_::Vector3d >& data);
+
+	CalibrateAccelerometer *calibrate() { return &m_calibrate; }
+
+	virtual double progress() const;
+	virtual int pass() const;
+	virtual void cancel();
+
+protected:
+	virtual void evaluate();
+
+private:
+	CalibrateAccelerometer m_calibrate;
+};
+
+////////////////////////////////////////////////////////
+
+/**
+ * @brief The GyroBiasJob class
+ * mean of the gyroscope data while the device is still.
+ * result: cp - bias, mean_radius - length of the bias, deviation - standard deviation
+ */
+class GyroBiasJob: public CalibrationJob
+{
+public:
+	GyroBiasJob(int type, const QVector< vector3_::Vector3d >& data);
+
+protected:
+	virtual void evaluate();
+
+private:
+	QVector< vector3_::Vector3d > m_data;
+};
+
+////////////////////////////////////////////////////////
+
+class CalibrationJobRunnable: public QRunnable
+{
+public:
+	CalibrationJobRunnable(const CalibrationJobPtr& job);
+protected:
+	virtual void run();
+private:
+	CalibrationJobPtr m_job;
+};
+
+#endif // CALIBRATIONJOB_H
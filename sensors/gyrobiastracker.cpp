@@ -0,0 +1,221 @@
+#include "gyrobiastracker.h"
+
+#include <cmath>
+
+using namespace vector3_;
+
+GyroBiasTracker::GyroBiasTracker(int window)
+	: m_window(200)
+	, m_threshold_gyro(400)
+	, m_threshold_accel(20000)
+	, m_temperature_bin(340)		/// 1 degree for MPU6050
+	, m_max_count(10000)
+	, m_pos(0)
+	, m_filled(0)
+	, m_variance_gyro(0)
+	, m_variance_accel(0)
+	, m_stationary(false)
+	, m_has_seed(false)
+	, m_cache_key(0)
+	, m_cache_valid(false)
+{
+	set_window(window);
+}
+
+void GyroBiasTracker::set_window(int value)
+{
+	m_window = qMax(2, value);
+	reset();
+}
+
+void GyroBiasTracker::set_thresholds(double gyro_variance, double accel_variance)
+{
+	m_threshold_gyro = gyro_variance;
+	m_threshold_accel = accel_variance;
+}
+
+void GyroBiasTracker::set_temperature_bin(double value)
+{
+	if(value <= 0)
+		return;
+	m_temperature_bin = value;
+	m_bins.clear();
+	m_cache_valid = false;
+}
+
+void GyroBiasTracker::set_max_count(int value)
+{
+	m_max_count = qMax(1, value);
+}
+
+void GyroBiasTracker::reset()
+{
+	m_samples.resize(m_window);
+	m_pos = 0;
+	m_filled = 0;
+	m_stationary = false;
+	m_variance_gyro = m_variance_accel = 0;
+	for(int i = 0; i < 3; i++){
+		m_sum_gyro[i] = m_sum2_gyro[i] = 0;
+		m_sum_accel[i] = m_sum2_accel[i] = 0;
+	}
+}
+
+void GyroBiasTracker::seed(const Vector3d &bias)
+{
+	m_bins.clear();
+	m_cache_valid = false;
+	m_seed = bias;
+	m_has_seed = true;
+}
+
+bool GyroBiasTracker::add(const Vector3d &gyro, const Vector3d &accel, double temp)
+{
+	if(m_has_seed){
+		Bin& bin = m_bins[bin_key(temp)];
+		bin.bias = m_seed;
+		bin.count = m_max_count;
+		m_has_seed = false;
+		m_cache_valid = false;
+	}
+
+	Sample& s = m_samples[m_pos];
+
+	/// the sample leaving the window is used for the bias: all samples after it in the window are still
+	if(m_filled == m_window){
+		if(m_stationary)
+			update_bin(s);
+
+		for(int i = 0; i < 3; i++){
+			m_sum_gyro[i] -= s.gyro[i];
+			m_sum2_gyro[i] -= s.gyro[i] * s.gyro[i];
+			m_sum_accel[i] -= s.accel[i];
+			m_sum2_accel[i] -= s.accel[i] * s.accel[i];
+		}
+	}else{
+		m_filled++;
+	}
+
+	for(int i = 0; i < 3; i++){
+		s.gyro[i] = gyro.data[i];
+		s.accel[i] = accel.data[i];
+		m_sum_gyro[i] += s.gyro[i];
+		m_sum2_gyro[i] += s.gyro[i] * s.gyro[i];
+		m_sum_accel[i] += s.accel[i];
+		m_sum2_accel[i] += s.accel[i] * s.accel[i];
+	}
+	s.temp = temp;
+
+	m_pos++;
+	if(m_pos >= m_window){
+		m_pos = 0;
+		/// remove the accumulated rounding error once per window
+		recalc_sums();
+	}
+
+	if(m_filled < m_window){
+		m_stationary = false;
+		return false;
+	}
+
+	double n = m_filled;
+	m_variance_gyro = m_variance_accel = 0;
+	for(int i = 0; i < 3; i++){
+		double mg = m_sum_gyro[i] / n;
+		double ma = m_sum_accel[i] / n;
+		m_variance_gyro += m_sum2_gyro[i] / n - mg * mg;
+		m_variance_accel += m_sum2_accel[i] / n - ma * ma;
+	}
+
+	m_stationary = m_variance_gyro < m_threshold_gyro && m_variance_accel < m_threshold_accel;
+
+	return m_stationary;
+}
+
+Vector3d GyroBiasTracker::bias(double temp) const
+{
+	if(m_bins.isEmpty())
+		return m_has_seed? m_seed : Vector3d();
+
+	int key = bin_key(temp);
+
+	if(m_bins.contains(key))
+		return m_bins[key].bias;
+
+	if(m_cache_valid && m_cache_key == key)
+		return m_cache_bias;
+
+	/// nearest bins below and above
+	bool is_lo = false, is_hi = false;
+	int lo = 0, hi = 0;
+	for(QHash< int, Bin >::const_iterator it = m_bins.begin(); it != m_bins.end(); it++){
+		if(it.key() < key && (!is_lo || it.key() > lo)){
+			lo = it.key();
+			is_lo = true;
+		}
+		if(it.key() > key && (!is_hi || it.key() < hi)){
+			hi = it.key();
+			is_hi = true;
+		}
+	}
+
+	Vector3d res;
+	if(is_lo && is_hi){
+		double t = (double)(key - lo) / (hi - lo);
+		res = m_bins[lo].bias * (1. - t) + m_bins[hi].bias * t;
+	}else if(is_lo){
+		res = m_bins[lo].bias;
+	}else{
+		res = m_bins[hi].bias;
+	}
+
+	m_cache_key = key;
+	m_cache_bias = res;
+	m_cache_valid = true;
+
+	return res;
+}
+
+Vector3d GyroBiasTracker::mean_accel() const
+{
+	if(!m_filled)
+		return Vector3d();
+	return Vector3d(m_sum_accel[0], m_sum_accel[1], m_sum_accel[2]) * (1.0 / m_filled);
+}
+
+int GyroBiasTracker::bin_key(double temp) const
+{
+	return (int)floor(temp / m_temperature_bin);
+}
+
+void GyroBiasTracker::recalc_sums()
+{
+	for(int i = 0; i < 3; i++){
+		m_sum_gyro[i] = m_sum2_gyro[i] = 0;
+		m_sum_accel[i] = m_sum2_accel[i] = 0;
+	}
+	for(int j = 0; j < m_filled; j++){
+		const Sample& s = m_samples[j];
+		for(int i = 0; i < 3; i++){
+			m_sum_gyro[i] += s.gyro[i];
+			m_sum2_gyro[i] += s.gyro[i] * s.gyro[i];
+			m_sum_accel[i] += s.accel[i];
+			m_sum2_accel[i] += s.accel[i] * s.accel[i];
+		}
+	}
+}
+
+void GyroBiasTracker::update_bin(const GyroBiasTracker::Sample &s)
+{
+	int key = bin_key(s.temp);
+
+	if(!m_bins.contains(key))
+		m_cache_valid = false;
+
+	Bin& bin = m_bins[key];
+	if(bin.count < m_max_count)
+		bin.count++;
+
+	Vector3d g(s.gyro[0], s.gyro[1], s.gyro[2]);
+	bin.bias += (g - bin.bias) * (1.0 / bin.count);
+}
@@ -0,0 +1,126 @@
+#ifndef GYROBIASTRACKER_H
+#define GYROBIASTRACKER_H
+
+#include <QVector>
+#include <QHash>
+
+#include "struct_controls.h"
+
+/**
+ * @brief The GyroBiasTracker class
+ * online detection of the still device by the variance of gyroscope and accelerometer
+ * in a sliding window and tracking of the gyroscope bias for each temperature bin.
+ * cost per sample is O(1)
+ */
+class GyroBiasTracker
+{
+public:
+	GyroBiasTracker(int window = 200);
+
+	/**
+	 * @brief set_window
+	 * count of samples for the variance
+	 * @param value
+	 */
+	void set_window(int value);
+	int window() const { return m_window; }
+	/**
+	 * @brief set_thresholds
+	 * sum of variances of the axes below which the device is still
+	 * @param gyro_variance
+	 * @param accel_variance
+	 */
+	void set_thresholds(double gyro_variance, double accel_variance);
+	double threshold_gyro() const { return m_threshold_gyro; }
+	double threshold_accel() const { return m_threshold_accel; }
+	/**
+	 * @brief set_temperature_bin
+	 * width of the bin in units of the gyroscope temperature
+	 * @param value
+	 */
+	void set_temperature_bin(double value);
+	double temperature_bin() const { return m_temperature_bin; }
+	/**
+	 * @brief set_max_count
+	 * after max_count samples in a bin the bias becomes an exponential mean with weight 1/max_count
+	 * @param value
+	 */
+	void set_max_count(int value);
+
+	void reset();
+	/**
+	 * @brief seed
+	 * replace bins by the bias of the explicit calibration. it becomes the bin of the temperature
+	 * of the next sample with the full weight, so the tracking continues from it
+	 * @param bias
+	 */
+	void seed(const vector3_::Vector3d& bias);
+	/**
+	 * @brief add
+	 * @param gyro - raw gyroscope
+	 * @param accel - raw accelerometer
+	 * @param temp - temperature of the gyroscope
+	 * @return true if the device is still
+	 */
+	bool add(const vector3_::Vector3d& gyro, const vector3_::Vector3d& accel, double temp);
+
+	bool is_stationary() const { return m_stationary; }
+	bool has_bias() const { return !m_bins.isEmpty() || m_has_seed; }
+	int count_bins() const { return m_bins.size(); }
+	/**
+	 * @brief bias
+	 * bias for the temperature. linear interpolation between nearest bins if the bin is empty
+	 * @param temp
+	 * @return
+	 */
+	vector3_::Vector3d bias(double temp) const;
+	/**
+	 * @brief mean_accel
+	 * mean of accelerometer in the window
+	 * @return
+	 */
+	vector3_::Vector3d mean_accel() const;
+	double variance_gyro() const { return m_variance_gyro; }
+	double variance_accel() const { return m_variance_accel; }
+
+private:
+	struct Sample{
+		double gyro[3];
+		double accel[3];
+		double temp;
+	};
+	struct Bin{
+		Bin(): count(0) {}
+		vector3_::Vector3d bias;
+		qint64 count;
+	};
+
+	int m_window;
+	double m_threshold_gyro;
+	double m_threshold_accel;
+	double m_temperature_bin;
+	int m_max_count;
+
+	QVector< Sample > m_samples;
+	int m_pos;
+	int m_filled;
+	double m_sum_gyro[3], m_sum2_gyro[3];
+	double m_sum_accel[3], m_sum2_accel[3];
+	double m_variance_gyro;
+	double m_variance_accel;
+	bool m_stationary;
+
+	QHash< int, Bin > m_bins;
+	vector3_::Vector3d m_seed;
+	bool m_has_seed;
+
+	mutable int m_cache_key;
+	mutable vector3_::Vector3d m_cache_bias;
+	mutable bool m_cache_valid;
+
+	int bin_key(double temp) const;
+	void recalc_sums();
+	void update_bin(const Sample& s);
+};
+
+#endif // GYROBIASTRACKER_H
@@ -26,6 +26,8 @@
 #include <chrono>
 #endif
 
+#include <math.h>
+
 //#include <GL/gl.h>
 
 #include <global.h>
@@ -112,6 +114,10 @@ void draw_line(const Vector3d& v1, const Vector3d& v2 = Vector3d(), const QColor
 ///////////////////////////////////////////////////
 
 const int max_trajectory_size = 200;
+/// maximum count of drawn points of one cloud
+const int default_point_budget = 500000;
+/// details of clouds smaller than this count of pixels are not drawn
+const double lod_pixels = 2;
 
 ///////////////////////////////
 /// \brief GyroData::GyroData
@@ -120,23 +126,34 @@ const int max_trajectory_size = 200;
 ///
 GyroData::GyroData(QObject *parent) :
 	VirtGLObject(parent)
+  , m_show_recorded_data(false)
+  , m_loading_log(false)
+  , m_buffered_count(0)
+  , m_buffers_capacity(0)
+  , m_use_buffers(true)
+  , m_lod_uploaded(false)
+  , m_point_budget(default_point_budget)
+  , m_max_displayed_size(0)
   , m_divider_accel(5000)
   , m_divider_gyro(5000)
   , m_percent_downloaded_data(1)
+  , m_index(0)
   , m_showing_downloaded_data(true)
   , m_is_play(false)
-  , m_current_playing_pos(0)
-  , m_index(0)
-  , m_is_draw_mean_sphere(true)
-  , m_show_calibrated_data(true)
+  , m_replay_engine(&m_replay)
+  , m_replay_to_socket(false)
+  , m_seek_pending(false)
   , m_write_data(false)
   , m_add_to_pool(false)
-  , m_show_recorded_data(false)
+  , m_is_draw_mean_sphere(true)
+  , m_show_calibrated_data(true)
 {
 	setType(GYRODATA);
 
-	connect(&m_timer_playing, SIGNAL(timeout()), this, SLOT(_on_timeout_playing()));
-	m_timer_playing.start(100);
+	connect(&m_replay_engine, SIGNAL(play_sample(const sc::StructTelemetry&)), this, SLOT(_on_play_sample(const sc::StructTelemetry&)));
+	connect(&m_replay_engine, SIGNAL(finished()), this, SLOT(_on_replay_finished()));
+	connect(&m_log_loader, SIGNAL(finished()), this, SLOT(_on_log_loaded()));
+	connect(&m_lod_builder, SIGNAL(finished()), this, SLOT(_on_lod_built()));
 
 	m_sensorsWork = new SensorsWork();
 	m_sensorsWork->moveToThread(m_sensorsWork);
@@ -145,8 +162,6 @@ GyroData::GyroData(QObject *parent) :
 	connect(m_sensorsWork, SIGNAL(fill_data_for_calibration(const sc::StructTelemetry&)), this, SLOT(fill_data_for_calibration(const sc::StructTelemetry&)));
 	connect(m_sensorsWork, SIGNAL(stop_calibration()), this, SLOT(_on_stop_calibration()));
 
-	connect(&m_sensorsWork->calibrate_thread(), SIGNAL(send_log(QString)), this, SLOT(_on_calibrate_log(QString)));
-
 
 	load_from_xml();
 }
@@ -221,92 +236,100 @@ void GyroData::openFile(const QString fileName)
 	if(!QFile::exists(fileName))
 		return;
 
-	QFile file(fileName);
-
-	if(!file.open(QIODevice::ReadOnly))
-		return;
+	m_log_loader.cancel();
+	m_loading_log = false;
+	m_checkpoints.clear();
+	m_seek_pending = false;
 
 	clear_data();
 
 	m_fileName = fileName;
 
-	QTextStream tstream(&file);
-
 	m_downloaded_telemetries.clear();
+	m_buffered_count = 0;
+	m_lod_builder.cancel();
+	for(int i = 0; i < PointsCount; i++){
+		m_lods[i].clear();
+	}
+	m_lod_uploaded = false;
 
-	int ind = -1;
-	while(!tstream.atEnd()){
-		ind++;
+	if(!m_replay.open(fileName)){
+		emit add_to_log("file not opened: \"" + m_fileName + "\"; " + m_replay.error());
+		return;
+	}
+	m_replay_engine.reset_clock();
+	if(m_max_displayed_size > 0 && m_replay.size() > (qint64)m_max_displayed_size * 1024 * 1024){
+		emit add_to_log("file opened for replay: \"" + m_fileName + "\"; size: "
+						+ QString::number(m_replay.size() / (1024 * 1024)) + " MiB");
+		return;
+	}
 
-		QString line = tstream.readLine();
-		line = line.trimmed();
-		QStringList sl = line.split(';');
+	m_loading_log = true;
+	m_log_loader.load(fileName);
+	emit add_to_log("file loading: \"" + m_fileName + "\"");
+}
 
-		StructTelemetry st;
+bool GyroData::is_loading() const
+{
+	return m_log_loader.is_loading();
+}
 
-		double a1, a2, a3, t, g1, g2, g3, f = 100, afs = 0, fs = 0;
-		long long tm = 0;
+double GyroData::loading_progress() const
+{
+	return m_log_loader.progress();
+}
 
-		if(!sl.size()){
-			qDebug() << "data in line" << ind << "not enough:" << sl.size();
-			continue;
-		}
-		if(sl.size() == 7){
-			a1	= sl[0].toDouble();
-			a2	= sl[1].toDouble();
-			a3	= sl[2].toDouble();
-			t	= sl[3].toDouble();
-			g1	= sl[4].toDouble();
-			g2	= sl[5].toDouble();
-			g3	= sl[6].toDouble();
-		}
-		if(sl.size() >= 13){
-			t	= sl[4].toDouble();
-			a1	= sl[5].toDouble();
-			a2	= sl[6].toDouble();
-			a3	= sl[7].toDouble();
-			g1	= sl[8].toDouble();
-			g2	= sl[9].toDouble();
-			g3	= sl[10].toDouble();
-			afs	= sl[11].toDouble();
-			fs	= sl[12].toDouble();
-			f	= sl[13].toDouble();
-		}
-		if(sl.size() >= 14){
-			tm = sl[14].toLongLong();
-		}
-		if(sl.size() >= 22){
-			int c1, c2, c3;
-			long long tick = 0;
-			c1 = sl[15].toInt();
-			c2 = sl[16].toInt();
-			c3 = sl[17].toInt();
-			tick = sl[18].toLongLong();
-			st.compass.data = Vector3i(c1, c2, c3);
-			st.compass.tick = tick;
-
-			c1 = sl[19].toInt();
-			c2 = sl[20].toInt();
-			tick = sl[21].toLongLong();
-			st.barometer.data = c1;
-			st.barometer.temp = c2;
-			st.barometer.tick = tick;
-		}
+void GyroData::cancel_loading()
+{
+	if(!m_log_loader.is_loading())
+		return;
+	m_log_loader.take(m_downloaded_telemetries);
+	m_log_loader.cancel();
+}
+
+void GyroData::_on_log_loaded()
+{
+	/// finished() of the previous load may come after the start of the next one
+	if(!m_loading_log || m_log_loader.is_loading())
+		return;
+	m_loading_log = false;
 
-		st.gyroscope.accel = (Vector3i(a1, a2, a3));
-		st.gyroscope.gyro =(Vector3i(g1, g2, g3));
-		st.gyroscope.temp = t;
-		st.gyroscope.afs_sel = afs;
-		st.gyroscope.fs_sel = fs;
-		st.gyroscope.freq = f;
-		st.gyroscope.tick = tm;
+	m_log_loader.take(m_downloaded_telemetries);
 
-		m_downloaded_telemetries.push_back(st);
+	if(m_log_loader.is_cancelled()){
+		emit add_to_log("file loading cancelled: \"" + m_fileName + "\"; count data: "
+						+ QString::number(m_downloaded_telemetries.size()));
+		build_lods();
+		return;
+	}
+	if(!m_log_loader.error().isEmpty()){
+		m_downloaded_telemetries.clear();
+		emit add_to_log("file not loaded: \"" + m_fileName + "\"; " + m_log_loader.error());
+		return;
 	}
 
-	emit add_to_log("file loaded: \"" + m_fileName + "\"; count data: " + QString::number(m_downloaded_telemetries.size()));
+	emit add_to_log("file loaded: \"" + m_fileName + "\"; count data: " + QString::number(m_downloaded_telemetries.size())
+					+ "; memory: " + QString::number(m_downloaded_telemetries.bytes() / 1024) + " KiB");
+	build_lods();
+}
 
-	file.close();
+void GyroData::build_lods()
+{
+	if(m_downloaded_telemetries.empty())
+		return;
+	m_lod_builder.build(m_downloaded_telemetries);
+}
+
+void GyroData::_on_lod_built()
+{
+	if(!m_lod_builder.take(m_lods[AccelPoints], m_lods[GyroPoints], m_lods[CompassPoints]))
+		return;
+	m_lod_uploaded = false;
+
+	emit add_to_log(QString("levels of detail: accelerometer %1, gyroscope %2, compass %3")
+					.arg(m_lods[AccelPoints].count_levels())
+					.arg(m_lods[GyroPoints].count_levels())
+					.arg(m_lods[CompassPoints].count_levels()));
 }
 
 void GyroData::set_address(const QHostAddress &host, ushort port)
@@ -408,14 +431,16 @@ bool GyroData::is_play() const
 
 void GyroData::play()
 {
-	if(!m_downloaded_telemetries.size())
+	if(!m_replay.is_open())
 		return;
 	m_is_play = true;
+	m_replay_engine.start();
 }
 
 void GyroData::pause()
 {
 	m_is_play = false;
+	m_replay_engine.pause();
 }
 
 void GyroData::stop()
@@ -423,36 +448,104 @@ void GyroData::stop()
 	if(m_is_play){
 	}
 	m_is_play = false;
-	m_current_playing_pos = 0;
+	m_replay_engine.pause();
+	m_replay.seek_percent(0);
+	m_replay_engine.reset_clock();
+	m_seek_pending = true;
 }
 
 double GyroData::percent_position() const
 {
-	int mm = m_downloaded_telemetries.size();
-	if(!mm)
-		return 0;
-	return 100.0 * m_current_playing_pos / mm;
+	return m_replay.percent_position();
 }
 
 void GyroData::set_position_playback(double position)
 {
 	if(position < 0 || position > 100)
 		return;
-	int mm = m_downloaded_telemetries.size();
-	double pos = mm * position / 100.0;
-	m_current_playing_pos = pos;
+	m_replay.seek_percent(position);
+	m_replay_engine.reset_clock();
+	/// the tick of the position is known from the first read sample
+	m_seek_pending = true;
+}
+
+bool GyroData::restore_checkpoint(qint64 tick)
+{
+	const ReplayCheckpoint* cp = m_checkpoints.nearest(tick);
+	if(!cp){
+		/// the consistent state only from the start of the log
+		sensorsWork()->restart_pipeline();
+		m_trajectory.clear();
+		m_checkpoints.clear();
+		m_index = 0;
+		/// the log without ticks can not be played up to the tick
+		if(!tick)
+			return false;
+
+		m_replay.seek_percent(0);
+		m_replay_engine.reset_clock();
+		m_replay_engine.fast_forward(tick);
+		return true;
+	}
+
+	sensorsWork()->set_state(cp->state);
+	m_index = cp->index;
+
+	m_replay.seek_tick(cp->tick);
+	m_replay_engine.reset_clock();
+	if(cp->tick < tick)
+		m_replay_engine.fast_forward(tick);
+	return true;
+}
+
+double GyroData::replay_speed() const
+{
+	return m_replay_engine.speed();
+}
+
+void GyroData::set_replay_speed(double value)
+{
+	m_replay_engine.set_speed(value);
+}
+
+bool GyroData::is_replay_unthrottled() const
+{
+	return m_replay_engine.is_unthrottled();
+}
+
+void GyroData::set_replay_unthrottled(bool value)
+{
+	m_replay_engine.set_unthrottled(value);
+}
+
+bool GyroData::is_replay_to_socket() const
+{
+	return m_replay_to_socket;
+}
+
+void GyroData::set_replay_to_socket(bool value)
+{
+	m_replay_to_socket = value;
+}
+
+int GyroData::point_budget() const
+{
+	return m_point_budget;
+}
+
+void GyroData::set_point_budget(int value)
+{
+	m_point_budget = qMax(1000, value);
 }
 
-double GyroData::freq_playing() const
+int GyroData::max_displayed_size() const
 {
-	double timeout = m_timer_playing.interval();
-	return 1000.0 / timeout;
+	return m_max_displayed_size;
 }
 
-void GyroData::set_freq_playing(double value)
+void GyroData::set_max_displayed_size(int value)
 {
-	double timeout = 1000.0 / value;
-	m_timer_playing.setInterval(timeout);
+	m_max_displayed_size = qMax(0, value);
 }
 
 void GyroData::reset()
@@ -465,6 +558,8 @@ void GyroData::set_init_position()
 	if(sensorsWork()){
 		sensorsWork()->set_position();
 	}
+	/// the history of the pipeline starts again
+	m_checkpoints.clear();
 
 	m_writed_telemetries.clear();
 }
@@ -474,22 +569,19 @@ bool GyroData::calibrate_accelerometer()
 	if(!sensorsWork())
 		return false;
 
-	if(sensorsWork()->calibrate_thread().is_progress())
+	if(sensorsWork()->is_calibrating(SensorsWork::Accelerometer))
 		return false;
 
-	QVector< StructTelemetry > & st = m_writed_telemetries;
+	const TelemetryColumns* st = &m_writed_telemetries;
 
-	if(!m_writed_telemetries.size()){
-		st = m_downloaded_telemetries;
+	if(st->empty()){
+		st = &m_downloaded_telemetries;
 
-		if(!m_downloaded_telemetries.size())
+		if(st->empty())
 			return false;
 	}
 
-	QVector< Vector3d > data;
-	foreach (StructTelemetry it, st) {
-		data.push_back(it.gyroscope.accel);
-	}
+	QVector< Vector3d > data = decimate_for_calibration(st->accel_vectors(), "accelerometer");
 
 	return sensorsWork()->calibrate_accelerometer(data);
 }
@@ -499,26 +591,54 @@ bool GyroData::calibrate_compass()
 	if(!sensorsWork())
 		return false;
 
-	if(sensorsWork()->calibrate_thread().is_progress())
+	if(sensorsWork()->is_calibrating(SensorsWork::Compass))
 		return false;
 
-	QVector< StructTelemetry > & st = m_writed_telemetries;
+	const TelemetryColumns* st = &m_writed_telemetries;
 
-	if(!m_writed_telemetries.size()){
-		st = m_downloaded_telemetries;
+	if(st->empty()){
+		st = &m_downloaded_telemetries;
 
-		if(!m_downloaded_telemetries.size())
+		if(st->empty())
 			return false;
 	}
 
-	QVector< Vector3d > data;
-	foreach (StructTelemetry it, st) {
-		data.push_back(it.compass.data);
-	}
+	QVector< Vector3d > data = decimate_for_calibration(st->compass_vectors(), "compass");
 
 	return sensorsWork()->calibrate_compass(data);
 }
 
+bool GyroData::calibrate_gyro_bias()
+{
+	if(!sensorsWork())
+		return false;
+
+	if(sensorsWork()->is_calibrating(SensorsWork::GyroBias))
+		return false;
+
+	if(!m_writed_telemetries.size())
+		return false;
+
+	return sensorsWork()->calibrate_gyro_bias(m_writed_telemetries.gyro_vectors());
+}
+
+QVector<Vector3d> GyroData::decimate_for_calibration(const QVector<Vector3d> &data, const QString &name)
+{
+	QVector< Vector3d > res = m_decimator.decimate(data);
+
+	emit add_to_log(QString("calibrate %1: decimated %2 -> %3; empty cells %4 of %5 (rows from top, '.' - missing orientation)")
+					.arg(name)
+					.arg(data.size())
+					.arg(res.size())
+					.arg(m_decimator.count_empty_cells())
+					.arg(m_decimator.count_cells()));
+	foreach (QString line, m_decimator.coverage()) {
+		emit add_to_log("  " + line);
+	}
+
+	return res;
+}
+
 bool GyroData::is_draw_mean_sphere() const
 {
 	return m_is_draw_mean_sphere;
@@ -573,12 +693,10 @@ void GyroData::cancel_write()
 
 void GyroData::log_recorded_data()
 {
-	WriteLog::instance()->write_data("recorded_data", m_writed_telemetries);
-}
-
-void GyroData::_on_calibrate_log(const QString &data)
-{
-	emit add_to_log(data);
+	const TelemetryColumns& data = m_writed_telemetries;
+	WriteLog::instance()->write_data("recorded_data", data.size(), [&data](int index){
+		return data.at(index);
+	});
 }
 
 void GyroData::_on_stop_calibration()
@@ -707,37 +825,7 @@ void GyroData::draw()
 	glPointSize(3);
 
 	if(m_showing_downloaded_data){
-		int count = m_percent_downloaded_data * m_downloaded_telemetries.size();
-
-		glColor3f(0, 1, 0);
-		glBegin(GL_POINTS);
-		for (int i = 0; i < count; i++) {
-			Vector3d v = m_downloaded_telemetries[i].gyroscope.accel;
-			if(m_show_calibrated_data)
-				v -= sensorsWork()->mean_sphere().cp;
-
-			Vector3d tmp(v * div_accel);
-			glVertex3dv(tmp.data);
-		}
-		glEnd();
-
-		glColor3f(1, 0, 0);
-		glBegin(GL_POINTS);
-		for (int i = 0; i< count; i++) {
-			Vector3d tmp(_V(m_downloaded_telemetries[i].gyroscope.gyro) * div_gyro);
-			glVertex3dv(tmp.data);
-		}
-		glEnd();
-
-		glColor3f(1, 0.8, 0.5);
-		glBegin(GL_POINTS);
-		for (int i = 0; i< count; i++) {
-			Vector3d v = SHV(m_downloaded_telemetries[i].compass.data);
-			v -= sensorsWork()->mean_sphere_compass().cp;
-			Vector3d tmp(v * compass_multiply);
-			glVertex3dv(tmp.data);
-		}
-		glEnd();
+		draw_loaded_data(div_gyro, div_accel);
 	}
 
 	glLineWidth(4);
@@ -957,8 +1045,200 @@ void GyroData::draw()
 	calc_parameters();
 }
 
+/// count of samples converted to floats at once
+const int buffer_part_samples = 64 * 1024;
+
+static inline Vector3i cloud_point(const TelemetryColumns& data, int cloud, int index)
+{
+	switch (cloud) {
+	case GyroData::AccelPoints:
+		return data.accel(index);
+	case GyroData::GyroPoints:
+		return data.gyro(index);
+	default:
+		return data.compass(index);
+	}
+}
+
+void GyroData::update_point_buffers()
+{
+	const int size = m_downloaded_telemetries.size();
+	/// the data is replaced
+	if(size < m_buffered_count)
+		m_buffered_count = 0;
+	if(!m_use_buffers || size == m_buffered_count)
+		return;
+
+	const int point_size = 3 * sizeof(float);
+
+	if(!m_points_buffers[0].isCreated()){
+		for(int i = 0; i < PointsCount; i++){
+			m_points_buffers[i].setUsagePattern(QGLBuffer::DynamicDraw);
+			if(!m_points_buffers[i].create()){
+				m_use_buffers = false;
+				emit add_to_log("vertex buffers are not supported, points are drawn in the immediate mode");
+				return;
+			}
+		}
+		m_buffers_capacity = 0;
+	}
+
+	int from = m_buffered_count;
+	if(size > m_buffers_capacity){
+		/// the reserve for the progressive load
+		m_buffers_capacity = qMax(size, m_buffers_capacity * 2);
+		for(int i = 0; i < PointsCount; i++){
+			m_points_buffers[i].bind();
+			m_points_buffers[i].allocate(m_buffers_capacity * point_size);
+		}
+		from = 0;
+	}
+
+	QVector< float > part;
+	for(int i = 0; i < PointsCount; i++){
+		m_points_buffers[i].bind();
+		for(int begin = from; begin < size; begin += buffer_part_samples){
+			const int end = qMin(size, begin + buffer_part_samples);
+			part.resize((end - begin) * 3);
+			float* dst = part.data();
+			for(int j = begin; j < end; j++, dst += 3){
+				Vector3i v = cloud_point(m_downloaded_telemetries, i, j);
+				dst[0] = v.x();
+				dst[1] = v.y();
+				dst[2] = v.z();
+			}
+			m_points_buffers[i].write(begin * point_size, part.constData(), part.size() * sizeof(float));
+		}
+		m_points_buffers[i].release();
+	}
+
+	m_buffered_count = size;
+}
+
+void GyroData::update_lod_buffers()
+{
+	if(!m_use_buffers || m_lod_uploaded)
+		return;
+
+	for(int i = 0; i < PointsCount; i++){
+		QVector< QGLBuffer >& buffers = m_lod_buffers[i];
+		for(int j = 0; j < buffers.size(); j++){
+			buffers[j].destroy();
+		}
+		buffers.clear();
+
+		for(int j = 0; j < m_lods[i].count_levels(); j++){
+			const QVector< quint32 >& indices = m_lods[i].level(j).indices;
+			buffers.push_back(QGLBuffer(QGLBuffer::IndexBuffer));
+			QGLBuffer& buffer = buffers.back();
+			buffer.setUsagePattern(QGLBuffer::StaticDraw);
+			if(!buffer.create()){
+				buffers.pop_back();
+				break;
+			}
+			buffer.bind();
+			buffer.allocate(indices.constData(), indices.size() * sizeof(quint32));
+			buffer.release();
+		}
+	}
+	m_lod_uploaded = true;
+}
+
+void GyroData::draw_loaded_data(double div_gyro, double div_accel)
+{
+	update_point_buffers();
+	update_lod_buffers();
+
+	const int count = m_percent_downloaded_data * (m_use_buffers? m_buffered_count : m_downloaded_telemetries.size());
+	if(!count)
+		return;
+
+	/// size of the pixel at the distance of the origin of the scene.
+	/// the frustum of GLSpace has the height 1 at the near plane 1
+	GLdouble mv[16];
+	GLint viewport[4];
+	glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const double distance = qMax(1., sqrt(mv[12] * mv[12] + mv[13] * mv[13] + mv[14] * mv[14]));
+	const double pixel = lod_pixels * distance / qMax(1, viewport[3]);
+
+	/// (v - cp) * divider
+	glPushMatrix();
+	glScaled(div_accel, div_accel, div_accel);
+	if(m_show_calibrated_data){
+		const Vector3d& cp = sensorsWork()->mean_sphere().cp;
+		glTranslated(-cp.x(), -cp.y(), -cp.z());
+	}
+	glColor3f(0, 1, 0);
+	draw_points(AccelPoints, count, pixel / div_accel);
+	glPopMatrix();
+
+	glPushMatrix();
+	glScaled(div_gyro, div_gyro, div_gyro);
+	glColor3f(1, 0, 0);
+	draw_points(GyroPoints, count, pixel / div_gyro);
+	glPopMatrix();
+
+	glPushMatrix();
+	glScaled(compass_multiply.x(), compass_multiply.y(), compass_multiply.z());
+	const Vector3d& cp = sensorsWork()->mean_sphere_compass().cp;
+	glTranslated(-cp.x(), -cp.y(), -cp.z());
+	glColor3f(1, 0.8, 0.5);
+	draw_points(CompassPoints, count, pixel / compass_multiply.x());
+	glPopMatrix();
+}
+
+void GyroData::draw_points(PointCloud cloud, int count, double max_cell)
+{
+	const PointCloudLod& lod = m_lods[cloud];
+	int level = -1, stride = 1;
+	if(!lod.empty() && lod.size() == m_downloaded_telemetries.size()){
+		level = lod.select(max_cell, count, m_point_budget);
+	}else if(count > m_point_budget){
+		/// levels are not built yet: every n-th sample
+		stride = (count + m_point_budget - 1) / m_point_budget;
+	}
+	const int count_level = level >= 0? lod.prefix(level, count) : 0;
+
+	if(m_use_buffers){
+		const bool use_level = level >= 0 && level < m_lod_buffers[cloud].size();
+		m_points_buffers[cloud].bind();
+		glEnableClientState(GL_VERTEX_ARRAY);
+		if(use_level){
+			glVertexPointer(3, GL_FLOAT, 0, 0);
+			m_lod_buffers[cloud][level].bind();
+			glDrawElements(GL_POINTS, count_level, GL_UNSIGNED_INT, 0);
+			m_lod_buffers[cloud][level].release();
+		}else{
+			glVertexPointer(3, GL_FLOAT, stride * 3 * sizeof(float), 0);
+			glDrawArrays(GL_POINTS, 0, (count + stride - 1) / stride);
+		}
+		glDisableClientState(GL_VERTEX_ARRAY);
+		m_points_buffers[cloud].release();
+		return;
+	}
+
+	glBegin(GL_POINTS);
+	if(level >= 0){
+		const QVector< quint32 >& indices = lod.level(level).indices;
+		for(int i = 0; i < count_level; i++){
+			Vector3i v = cloud_point(m_downloaded_telemetries, cloud, indices[i]);
+			glVertex3i(v.x(), v.y(), v.z());
+		}
+	}else{
+		for(int i = 0; i < count; i += stride){
+			Vector3i v = cloud_point(m_downloaded_telemetries, cloud, i);
+			glVertex3i(v.x(), v.y(), v.z());
+		}
+	}
+	glEnd();
+}
+
 void GyroData::tick()
 {
+	/// parts of the log loaded in the background
+	m_log_loader.take(m_downloaded_telemetries);
+
 	emit set_text("sphere_radius", QString::number(sensorsWork()->mean_sphere().mean_radius, 'f', 1));
 	emit set_text("sphere_cp", sensorsWork()->mean_sphere().cp);
 	emit set_text("sphere_dev", QString::number(sensorsWork()->mean_sphere().deviation, 'f', 1));
@@ -978,22 +1258,46 @@ void GyroData::clear_data()
 	m_writed_telemetries.clear();
 }
 
-void GyroData::_on_timeout_playing()
+void GyroData::_on_play_sample(const StructTelemetry &st)
 {
-	if(m_is_play && (m_downloaded_telemetries.size())){
+	if(!sensorsWork())
+		return;
 
-		if(m_current_playing_pos >= m_downloaded_telemetries.size()){
-			m_current_playing_pos = 0;
-			set_init_position();
+	if(m_replay_to_socket){
+		/// the state of the pipeline is not restored: samples are analyzed in the thread of SensorsWork
+		m_seek_pending = false;
+
+		/// the same datagram as from the device, it is parsed and logged in the thread of SensorsWork
+		QByteArray data;
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		StructTelemetry tmp(st);
+		tmp.write_to(stream);
+		m_replay_socket.writeDatagram(data, QHostAddress(QHostAddress::LocalHost), sensorsWork()->port());
+	}else{
+		if(m_seek_pending){
+			m_seek_pending = false;
+			/// the sample is played again after the catch up from the checkpoint
+			if(restore_checkpoint(st.gyroscope.tick))
+				return;
+		}
+		if(m_checkpoints.is_due(m_index, st.gyroscope.tick)){
+			m_checkpoints.add(m_index, st.gyroscope.tick, sensorsWork()->state());
 		}
+		sensorsWork()->analyze_telemetry(st);
+	}
 
-		StructTelemetry st = m_downloaded_telemetries[m_current_playing_pos];
+	m_index++;
+}
 
-		st = sensorsWork()->analyze_telemetry(st);
+void GyroData::_on_replay_finished()
+{
+	/// playing from the beginning
+	m_replay.seek_percent(0);
+	m_replay_engine.reset_clock();
+	set_init_position();
 
-		m_current_playing_pos++;
-		m_index++;
-	}
+	if(m_is_play)
+		m_replay_engine.start();
 }
 
 void GyroData::load_from_xml()
@@ -1019,10 +1323,18 @@ void GyroData::load_from_xml()
 	if(port)
 		m_port = port;
 
-	double freq = sxml["freq_playing"];
-	if(freq){
-		set_freq_playing(freq);
+	double speed = sxml["replay_speed"];
+	if(speed > 0){
+		set_replay_speed(speed);
+	}
+	bool unthrottled = sxml["replay_unthrottled"];
+	set_replay_unthrottled(unthrottled);
+	m_replay_to_socket = sxml["replay_to_socket"];
+	int budget = sxml["point_budget"];
+	if(budget > 0){
+		set_point_budget(budget);
 	}
+	set_max_displayed_size(sxml["max_displayed_size"]);
 
 	m_is_draw_mean_sphere = sxml["draw_mean_sphere"];
 
@@ -1059,8 +1371,11 @@ void GyroData::save_to_xml()
 	sxml << "ip" << m_addr.toString();
 	sxml << "port" << m_port;
 
-	double freq = freq_playing();
-	sxml << "freq_playing" << freq;
+	sxml << "replay_speed" << replay_speed();
+	sxml << "replay_unthrottled" << is_replay_unthrottled();
+	sxml << "replay_to_socket" << m_replay_to_socket;
+	sxml << "point_budget" << m_point_budget;
+	sxml << "max_displayed_size" << m_max_displayed_size;
 	sxml << "draw_mean_sphere" << m_is_draw_mean_sphere;
 
 	sxml << "show_calibrated_data" << m_show_calibrated_data;
@@ -1095,8 +1410,8 @@ void GyroData::draw_recored_data()
 {	
 	glColor3f(1, 0.5, 0.3);
 	glBegin(GL_POINTS);
-	foreach (StructTelemetry st, m_writed_telemetries) {
-		Vector3d v = st.gyroscope.accel;
+	for(int i = 0; i < m_writed_telemetries.size(); i++){
+		Vector3d v = m_writed_telemetries.accel(i);
 		v *= 1. / m_divider_accel;
 		glVertex3dv(v.data);
 	}
@@ -1107,8 +1422,8 @@ void GyroData::draw_recored_data()
 
 	glColor3f(0.5, 1, 0.3);
 	glBegin(GL_POINTS);
-	foreach (StructTelemetry st, m_writed_telemetries) {
-		Vector3d v = st.compass.data;
+	for(int i = 0; i < m_writed_telemetries.size(); i++){
+		Vector3d v = m_writed_telemetries.compass(i);
 		v -= sensorsWork()->mean_sphere_compass().cp;
 		v = v * compass_multiply;
 		glVertex3dv(v.data);
@@ -6,12 +6,21 @@
 #include <QVector>
 #include <QTimer>
 #include <QHostAddress>
+#include <QUdpSocket>
 #include <QTime>
 #include <QElapsedTimer>
 #include <QMap>
 #include <QColor>
+#include <QGLBuffer>
 
 #include "sensorswork.h"
+#include "spheregriddecimator.h"
+#include "telemetrycolumns.h"
+#include "replaysource.h"
+#include "replayengine.h"
+#include "asynclogloader.h"
+#include "replaycheckpoints.h"
+#include "pointcloudlod.h"
 
 /**
  * @brief The GyroData class
@@ -23,6 +32,16 @@ public:
 	enum{
 		GYRODATA  = TYPE_VGL + 2
 	};
+	/**
+	 * @brief The PointCloud enum
+	 * point clouds of the loaded telemetry
+	 */
+	enum PointCloud{
+		AccelPoints,
+		GyroPoints,
+		CompassPoints,
+		PointsCount
+	};
 
 	explicit GyroData(QObject *parent = 0);
 	virtual ~GyroData();
@@ -36,9 +55,27 @@ public:
 	QString fileName() const;
 	/**
 	 * @brief openFile
-	 * @param fileName
+	 * open the log for the replay. small logs are also loaded for the view in the background,
+	 * loaded parts are shown as they arrive
+	 * @param fileName - log or index of the session
 	 */
 	void openFile(const QString fileName);
+	/**
+	 * @brief is_loading
+	 * the log for the view is loaded in the background
+	 * @return
+	 */
+	bool is_loading() const;
+	/**
+	 * @brief loading_progress
+	 * @return part of the loaded log [0, 1]
+	 */
+	double loading_progress() const;
+	/**
+	 * @brief cancel_loading
+	 * stop the load, already loaded data stays in the view
+	 */
+	void cancel_loading();
 	void set_address(const QHostAddress& host, ushort port);
 	/**
 	 * @brief send_start_to_net
@@ -139,23 +176,48 @@ public:
 	double percent_position() const;
 	/**
 	 * @brief set_position_playback
-	 * set position in percent for playback
+	 * set position in percent for playback. the pipeline is restored from the nearest checkpoint
+	 * and caught up to the position when the first sample at the position is read
 	 * @param position
 	 */
 	void set_position_playback(double position);
 
 	/**
-	 * @brief freq_playing
-	 * current frequency of playing
+	 * @brief replay_speed
+	 * multiplier of the time of the log for playing
 	 * @return
 	 */
-	double freq_playing() const;
+	double replay_speed() const;
+	void set_replay_speed(double value);
 	/**
-	 * @brief set_freq_playing
-	 * set frequency of playing
-	 * @param value
+	 * @brief is_replay_unthrottled
+	 * playing as fast as possible
+	 * @return
+	 */
+	bool is_replay_unthrottled() const;
+	void set_replay_unthrottled(bool value);
+	/**
+	 * @brief is_replay_to_socket
+	 * samples of the replay are sent as datagrams to the own receiver of SensorsWork
+	 * through the loopback, so they pass the same path as the telemetry from the device
+	 * @return
+	 */
+	bool is_replay_to_socket() const;
+	void set_replay_to_socket(bool value);
+	/**
+	 * @brief point_budget
+	 * maximum count of drawn points of each cloud of the loaded telemetry
+	 * @return
+	 */
+	int point_budget() const;
+	void set_point_budget(int value);
+	/**
+	 * @brief max_displayed_size
+	 * larger logs are opened only for the replay and are not shown
+	 * @return size in MiB, 0 if all logs are shown
 	 */
-	void set_freq_playing(double value);
+	int max_displayed_size() const;
+	void set_max_displayed_size(int value);
 	/**
 	 * @brief start_calc_center_gyro
 	 */
@@ -203,6 +265,12 @@ public:
 
 	bool calibrate_compass();
 	bool calibrate_accelerometer();
+	/**
+	 * @brief calibrate_gyro_bias
+	 * mean of the recorded gyroscope data. the device must be still while recording
+	 * @return
+	 */
+	bool calibrate_gyro_bias();
 
 	void log_recorded_data();
 
@@ -216,8 +284,10 @@ signals:
 	void set_text(const QString& key, const QString text);
 
 public slots:
-	void _on_timeout_playing();
-	void _on_calibrate_log(const QString& data);
+	void _on_play_sample(const sc::StructTelemetry& st);
+	void _on_replay_finished();
+	void _on_log_loaded();
+	void _on_lod_built();
 	void _on_stop_calibration();
 	void fill_data_for_calibration(const sc::StructTelemetry& st);
 
@@ -237,7 +307,24 @@ private:
 	ushort m_port;
 
 	QString m_fileName;
-	QVector< sc::StructTelemetry > m_downloaded_telemetries;
+	TelemetryColumns m_downloaded_telemetries;
+	AsyncLogLoader m_log_loader;
+	bool m_loading_log;
+	/// raw points of the loaded telemetry in the video memory, xyz floats
+	QGLBuffer m_points_buffers[PointsCount];
+	/// count of samples written to buffers
+	int m_buffered_count;
+	int m_buffers_capacity;
+	/// false if buffers can not be created, then points are drawn in the immediate mode
+	bool m_use_buffers;
+	/// levels of detail of clouds, built after the load
+	PointCloudLodBuilder m_lod_builder;
+	PointCloudLod m_lods[PointsCount];
+	/// indices of levels in the video memory
+	QVector< QGLBuffer > m_lod_buffers[PointsCount];
+	bool m_lod_uploaded;
+	int m_point_budget;
+	int m_max_displayed_size;
 	double m_divider_accel;
 	double m_divider_gyro;
 	double m_percent_downloaded_data;
@@ -245,12 +332,16 @@ private:
 
 	bool m_showing_downloaded_data;
 	bool m_is_play;
-	int m_current_playing_pos;
-
-	QTimer m_timer_playing;
-
-	QVector< sc::StructTelemetry > m_writed_telemetries;
-	QVector< sc::StructTelemetry > m_pool_writed_telemetries;
+	ReplaySource m_replay;
+	ReplayEngine m_replay_engine;
+	QUdpSocket m_replay_socket;
+	bool m_replay_to_socket;
+	/// checkpoints of SensorsWork for the seek. not used when the replay goes through the socket
+	ReplayCheckpoints m_checkpoints;
+	bool m_seek_pending;
+
+	TelemetryColumns m_writed_telemetries;
+	TelemetryColumns m_pool_writed_telemetries;
 	bool m_write_data;
 	bool m_add_to_pool;
 
@@ -261,6 +352,8 @@ private:
 
 	SphereGL m_sphereGl;
 
+	SphereGridDecimator m_decimator;
+
 	void init_sphere();
 
 	void clear_data();
@@ -270,8 +363,49 @@ private:
 	void draw_text(const vector3_::Vector3d& v, const QString& text, const QColor &col = Qt::white);
 	void draw_sphere();
 	void draw_recored_data();
+	/**
+	 * @brief update_point_buffers
+	 * write new samples of the loaded telemetry to buffers. all samples are written again
+	 * if the data is replaced or buffers are reallocated
+	 */
+	void update_point_buffers();
+	void update_lod_buffers();
+	/**
+	 * @brief build_lods
+	 * start the build of levels for the loaded telemetry in the background
+	 */
+	void build_lods();
+	/**
+	 * @brief draw_loaded_data
+	 * point clouds with the calibration offset and the divider applied by the transform
+	 */
+	void draw_loaded_data(double div_gyro, double div_accel);
+	/**
+	 * @brief draw_points
+	 * @param cloud
+	 * @param count - count of shown samples
+	 * @param max_cell - size of details in units of the cloud that are not seen on the screen
+	 */
+	void draw_points(PointCloud cloud, int count, double max_cell);
 
 	void calc_parameters();
+	/**
+	 * @brief restore_checkpoint
+	 * restore the pipeline before the tick and catch up to it.
+	 * without the checkpoint the pipeline is reset and the log is played from the start up to the tick,
+	 * so checkpoints are recorded only by the continuous play from the first sample
+	 * @param tick - target of the seek
+	 * @return false if the sample of the tick is played at once (the log has no ticks)
+	 */
+	bool restore_checkpoint(qint64 tick);
+	/**
+	 * @brief decimate_for_calibration
+	 * bounded count of samples for each orientation and log of the coverage
+	 * @param data
+	 * @param name - name of the sensor for the log
+	 * @return
+	 */
+	QVector< vector3_::Vector3d > decimate_for_calibration(const QVector< vector3_::Vector3d >& data, const QString& name);
 };
 
 #endif // GYRODATA_H
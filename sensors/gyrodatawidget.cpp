@@ -44,11 +44,14 @@ void GyroDataWidget::init_model()
 	ui->dsb_accel_data->setValue(m_model->divider_accel());
 	ui->dsb_div_gyro->setValue(m_model->divider_gyro());
 	ui->cb_show_loaded->setChecked(m_model->showing_downloaded_data());
-	ui->dsb_frequency_playing->setValue(m_model->freq_playing());
+	ui->dsb_speed_playing->setValue(m_model->replay_speed());
+	ui->chb_unthrottled_playing->setChecked(m_model->is_replay_unthrottled());
+	ui->chb_replay_to_socket->setChecked(m_model->is_replay_to_socket());
 	ui->chb_calibrate_sphere->setChecked(m_model->is_draw_mean_sphere());
 	ui->chb_recorded_data->setChecked(m_model->is_show_recorded_data());
 
 	ui->widget_pass->setVisible(false);
+	ui->widget_loading->setVisible(m_model->is_loading());
 
 	QString val = QString("center: %1; radius: %2; deviation: %3")
 			.arg(m_model->sensorsWork()->mean_sphere().cp)
@@ -74,9 +77,13 @@ void GyroDataWidget::_on_timeout_cfg()
 		emit set_status_bar_text("telemetry not received");
 	}
 
-	if(m_model->is_play()){
+	if(m_model->is_play() && !ui->hs_playing_data->isSliderDown()){
 		ui->hs_playing_data->setValue(m_model->percent_position());
 	}
+	ui->widget_loading->setVisible(m_model->is_loading());
+	if(m_model->is_loading()){
+		ui->pb_loading->setValue(m_model->loading_progress() * 100.0);
+	}
 	ui->lb_count_value->setText("count: " + QString::number(m_model->sensorsWork()->count_gyro_offset_data()));
 	ui->lb_write_data->setText("count: " + QString::number(m_model->count_write_data()));
 
@@ -96,37 +103,70 @@ void GyroDataWidget::_on_timeout_tmcalib()
 {
 	if(!m_model || !m_model->sensorsWork())
 		return;
-	if(m_model->sensorsWork()->calibrate_thread().is_done()){
+
+	double progress = 1;
+	int pass = 0;
+
+	foreach (int type, m_watch_calibrations) {
+		CalibrationJobPtr job = m_model->sensorsWork()->calibration_job((SensorsWork::TypeOfCalibrate)type);
+		if(job.isNull() || job->is_done()){
+			m_watch_calibrations.remove(type);
+			update_calibration_values((SensorsWork::TypeOfCalibrate)type);
+			continue;
+		}
+		/// show the slowest job
+		if(job->progress() <= progress){
+			progress = job->progress();
+			pass = job->pass();
+		}
+	}
+
+	if(m_watch_calibrations.isEmpty()){
 		m_tmcalib.stop();
 		ui->widget_pass->setVisible(false);
 		ui->lb_work_compass->setVisible(false);
+		return;
+	}
 
-		switch (m_model->sensorsWork()->typeOfCalibrate()) {
-			case SensorsWork::Accelerometer:
-				{
-					QString val = QString("center: %1; radius: %2; deviation: %3")
-							.arg(m_model->sensorsWork()->mean_sphere().cp)
-							.arg(m_model->sensorsWork()->mean_sphere().mean_radius)
-							.arg(m_model->sensorsWork()->mean_sphere().deviation);
-					ui->lb_values_accel->setText(val);
-				}
-				break;
-			case SensorsWork::Compass:
-				{
-					QString val = QString("center: %1; radius: %2; deviation: %3")
-							.arg(m_model->sensorsWork()->mean_sphere_compass().cp)
-							.arg(m_model->sensorsWork()->mean_sphere_compass().mean_radius)
-							.arg(m_model->sensorsWork()->mean_sphere_compass().deviation);
-					ui->lb_values->setText(val);
-				}
-				break;
-			default:
-				break;
-		}
+	ui->lb_work_compass->setVisible(m_watch_calibrations.contains(SensorsWork::Compass));
+	ui->pb_calibrate->setValue(progress * 100.0);
+	ui->lb_pass->setText("pass: " + QString::number(pass));
+}
+
+void GyroDataWidget::update_calibration_values(SensorsWork::TypeOfCalibrate type)
+{
+	switch (type) {
+		case SensorsWork::Accelerometer:
+			{
+				QString val = QString("center: %1; radius: %2; deviation: %3")
+						.arg(m_model->sensorsWork()->mean_sphere().cp)
+						.arg(m_model->sensorsWork()->mean_sphere().mean_radius)
+						.arg(m_model->sensorsWork()->mean_sphere().deviation);
+				ui->lb_values_accel->setText(val);
+			}
+			break;
+		case SensorsWork::Compass:
+			{
+				QString val = QString("center: %1; radius: %2; deviation: %3")
+						.arg(m_model->sensorsWork()->mean_sphere_compass().cp)
+						.arg(m_model->sensorsWork()->mean_sphere_compass().mean_radius)
+						.arg(m_model->sensorsWork()->mean_sphere_compass().deviation);
+				ui->lb_values->setText(val);
+			}
+			break;
+		default:
+			break;
 	}
+}
+
+void GyroDataWidget::watch_calibration(SensorsWork::TypeOfCalibrate type)
+{
+	m_watch_calibrations.insert(type);
 
-	ui->pb_calibrate->setValue(m_model->sensorsWork()->calibrate_thread().pass_part_evaluate() * 100.0);
-	ui->lb_pass->setText("pass: " + QString::number(m_model->sensorsWork()->calibrate_thread().pass()));
+	ui->widget_pass->setVisible(true);
+	ui->pb_calibrate->setValue(0);
+	ui->lb_pass->setText("pass: 0");
+	m_tmcalib.start();
 }
 
 ///////////////////////////////////
@@ -138,7 +178,7 @@ void GyroDataWidget::on_pushButton_5_clicked()
 		return;
 	QFileDialog dlg;
 
-	dlg.setNameFilter("*.csv");
+	dlg.setNameFilter("*.csv *.glsb *.glsz *.idx");
 
 	if(dlg.exec()){
 		m_model->openFile(dlg.selectedFiles()[0]);
@@ -190,11 +230,25 @@ void GyroDataWidget::on_cb_show_loaded_clicked(bool checked)
 	m_model->set_showing_downloaded_data(checked);
 }
 
-void GyroDataWidget::on_dsb_frequency_playing_valueChanged(double arg1)
+void GyroDataWidget::on_dsb_speed_playing_valueChanged(double arg1)
+{
+	if(!m_model)
+		return;
+	m_model->set_replay_speed(arg1);
+}
+
+void GyroDataWidget::on_chb_unthrottled_playing_clicked(bool checked)
+{
+	if(!m_model)
+		return;
+	m_model->set_replay_unthrottled(checked);
+}
+
+void GyroDataWidget::on_chb_replay_to_socket_clicked(bool checked)
 {
 	if(!m_model)
 		return;
-	m_model->set_freq_playing(arg1);
+	m_model->set_replay_to_socket(checked);
 }
 
 void GyroDataWidget::on_hs_playing_data_valueChanged(int value)
@@ -202,6 +256,13 @@ void GyroDataWidget::on_hs_playing_data_valueChanged(int value)
 //	m_model->set_position_playback(value);
 }
 
+void GyroDataWidget::on_hs_playing_data_sliderMoved(int position)
+{
+	if(!m_model)
+		return;
+	m_model->set_position_playback(position);
+}
+
 void GyroDataWidget::on_pb_play_clicked(bool checked)
 {
 	if(!m_model)
@@ -256,10 +317,7 @@ void GyroDataWidget::on_pushButton_10_clicked(bool checked)
 	if(!m_model)
 		return;
 	if(m_model->calibrate_accelerometer()){
-		ui->widget_pass->setVisible(true);
-		ui->pb_calibrate->setValue(0);
-		ui->lb_pass->setText("pass: " + QString::number(m_model->sensorsWork()->calibrate_thread().pass()));
-		m_tmcalib.start();
+		watch_calibration(SensorsWork::Accelerometer);
 	}
 }
 
@@ -371,10 +429,17 @@ void GyroDataWidget::on_pb_calibrate_compass_clicked()
 
 	if(m_model->calibrate_compass()){
 		ui->lb_work_compass->setVisible(true);
-		ui->widget_pass->setVisible(true);
-		ui->pb_calibrate->setValue(0);
-		ui->lb_pass->setText("pass: " + QString::number(m_model->sensorsWork()->calibrate_thread().pass()));
-		m_tmcalib.start();
+		watch_calibration(SensorsWork::Compass);
+	}
+}
+
+void GyroDataWidget::on_pb_calibrate_gyro_bias_clicked()
+{
+	if(!m_model)
+		return;
+
+	if(m_model->calibrate_gyro_bias()){
+		watch_calibration(SensorsWork::GyroBias);
 	}
 }
 
@@ -411,3 +476,11 @@ void GyroDataWidget::on_pb_gpio_send_clicked()
 	servo.pin = ui->sb_gpio_pin->value();
 	m_model->send_servo(servo);
 }
+
+void GyroDataWidget::on_pb_cancel_loading_clicked()
+{
+	if(!m_model)
+		return;
+	m_model->cancel_loading();
+	ui->widget_loading->setVisible(false);
+}
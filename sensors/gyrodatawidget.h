@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QTimer>
+#include <QSet>
 
 #include "gyrodata.h"
 
@@ -54,10 +55,16 @@ public slots:
 
 	void on_cb_show_loaded_clicked(bool checked);
 
-	void on_dsb_frequency_playing_valueChanged(double arg1);
+	void on_dsb_speed_playing_valueChanged(double arg1);
+
+	void on_chb_unthrottled_playing_clicked(bool checked);
+
+	void on_chb_replay_to_socket_clicked(bool checked);
 
 	void on_hs_playing_data_valueChanged(int value);
 
+	void on_hs_playing_data_sliderMoved(int position);
+
 	void on_pb_play_clicked(bool checked);
 
 	void on_pb_stop_clicked();
@@ -102,6 +109,8 @@ private slots:
 
 	void on_pb_calibrate_compass_clicked();
 
+	void on_pb_calibrate_gyro_bias_clicked();
+
 	void on_pb_reset_compass_vcalibrate_clicked();
 
 	void on_le_ip_gyro_data_returnPressed();
@@ -110,14 +119,19 @@ private slots:
 
 	void on_pb_gpio_send_clicked();
 
+	void on_pb_cancel_loading_clicked();
+
 private:
 	Ui::GyroDataWidget *ui;
 	QTimer m_timer_cfg;
 	QTimer m_tmcalib;
 
 	GyroData* m_model;
+	QSet< int > m_watch_calibrations;
 
 	void init_model();
+	void watch_calibration(SensorsWork::TypeOfCalibrate type);
+	void update_calibration_values(SensorsWork::TypeOfCalibrate type);
 };
 
 #endif // GYRODATAWIDGET_H
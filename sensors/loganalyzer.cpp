@@ -0,0 +1,368 @@
+#include "loganalyzer.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sensorswork.h"
+#include "telemetryloader.h"
+#include "telemetrycolumns.h"
+#include "spheregriddecimator.h"
+
+using namespace sc;
+using namespace vector3_;
+using namespace quaternions;
+
+/// interval between ticks longer than this count of periods is the gap
+const double gap_periods = 2;
+
+/**
+ * @brief attitude
+ * roll, pitch and yaw in degrees
+ */
+static Vector3d attitude(const Quaternion& q_in)
+{
+	Quaternion q = q_in.normalized();
+	double w = q.w, x = q.x(), y = q.y(), z = q.z();
+
+	double roll = atan2(2. * (w * x + y * z), 1. - 2. * (x * x + y * y));
+	double pitch = asin(qBound(-1., 2. * (w * y - z * x), 1.));
+	double yaw = atan2(2. * (w * z + x * y), 1. - 2. * (y * y + z * z));
+
+	return Vector3d(roll, pitch, yaw) * (180. / M_PI);
+}
+
+static QString json_string(const QString& value)
+{
+	QString res = value;
+	res.replace("\\", "\\\\");
+	res.replace("\"", "\\\"");
+	return "\"" + res + "\"";
+}
+
+static QString csv_string(const QString& value)
+{
+	QString res = value;
+	res.replace("\"", "\"\"");
+	return "\"" + res + "\"";
+}
+
+/////////////////////////////////
+
+class AnalyzeRunnable: public QRunnable
+{
+public:
+	AnalyzeRunnable(const QString& fileName, const QString& calibration, LogSummary* result,
+					QMutex* output, int* done, int total)
+		: m_fileName(fileName)
+		, m_calibration(calibration)
+		, m_result(result)
+		, m_output(output)
+		, m_done(done)
+		, m_total(total)
+	{
+	}
+
+	virtual void run(){
+		*m_result = LogAnalyzer::analyze_file(m_fileName, m_calibration);
+
+		QMutexLocker lock(m_output);
+		(*m_done)++;
+		QTextStream err(stderr);
+		err << "analyzed " << *m_done << "/" << m_total << ": " << m_fileName;
+		if(!m_result->error.isEmpty())
+			err << "; " << m_result->error;
+		err << "\n";
+	}
+
+private:
+	QString m_fileName;
+	QString m_calibration;
+	LogSummary* m_result;
+	QMutex* m_output;
+	int* m_done;
+	int m_total;
+};
+
+/////////////////////////////////
+
+LogSummary::LogSummary()
+	: samples(0)
+	, duration(0)
+	, rate(0)
+	, gaps(0)
+	, max_gap(0)
+	, has_gyro_bias(false)
+	, has_attitude(false)
+{
+}
+
+/////////////////////////////////
+
+LogAnalyzer::LogAnalyzer()
+	: m_threads(QThread::idealThreadCount())
+{
+}
+
+QStringList LogAnalyzer::collect(const QString &path)
+{
+	QStringList res;
+	QFileInfo fi(path);
+
+	QDir dir;
+	QStringList filters;
+	if(fi.isDir()){
+		dir = QDir(path);
+		filters << "*.csv" << "*" + TelemetryFormat::extension(TelemetryFormat::Binary)
+				<< "*" + TelemetryFormat::extension(TelemetryFormat::Compressed);
+	}else{
+		dir = fi.absoluteDir();
+		filters << fi.fileName();
+	}
+
+	foreach (const QString& name, dir.entryList(filters, QDir::Files, QDir::Name)) {
+		res << dir.absoluteFilePath(name);
+	}
+	return res;
+}
+
+LogSummary LogAnalyzer::analyze_file(const QString &fileName, const QString &calibration)
+{
+	LogSummary res;
+	res.file = fileName;
+
+	TelemetryColumns data;
+	TelemetryLoader loader;
+	if(!loader.load(fileName, data)){
+		res.error = loader.error();
+		return res;
+	}
+	res.samples = data.size();
+	if(data.empty()){
+		res.error = "no samples";
+		return res;
+	}
+
+	/// ticks
+	const qint64 first = data.tick(0), last = data.tick(data.size() - 1);
+	res.duration = (last - first) / 1e+3;
+	if(res.duration > 0)
+		res.rate = (data.size() - 1) / res.duration;
+
+	const StructTelemetry st0 = data.at(0);
+	const double period = st0.gyroscope.freq > 0? 1000. / st0.gyroscope.freq
+												 : (data.size() > 1? (last - first) / (data.size() - 1.) : 0);
+	for(int i = 1; i < data.size(); i++){
+		double delta = data.tick(i) - data.tick(i - 1);
+		res.max_gap = qMax(res.max_gap, delta);
+		if(period > 0 && delta > gap_periods * period)
+			res.gaps++;
+	}
+
+	/// the orientation pipeline without the socket: the thread of SensorsWork is not started
+	SensorsWork work(0, false);
+	if(!calibration.isEmpty() && !work.load_calibrate(calibration)){
+		res.error = "calibration is not loaded: " + calibration;
+		return res;
+	}
+	for(int i = 0; i < data.size(); i++){
+		work.analyze_telemetry(data.at(i));
+
+		if(work.is_calculated()){
+			Vector3d a = attitude(work.rotate_quaternion);
+			if(!res.has_attitude){
+				res.attitude_min = res.attitude_max = a;
+				res.has_attitude = true;
+			}
+			for(int j = 0; j < 3; j++){
+				res.attitude_min.data[j] = qMin(res.attitude_min.data[j], a.data[j]);
+				res.attitude_max.data[j] = qMax(res.attitude_max.data[j], a.data[j]);
+			}
+		}
+	}
+
+	const GyroBiasTracker& tracker = work.gyro_bias_tracker();
+	if(tracker.has_bias()){
+		res.has_gyro_bias = true;
+		res.gyro_bias = tracker.bias(data.at(data.size() - 1).gyroscope.temp);
+	}
+
+	/// the sphere of the accelerometer on the decimated data
+	SphereGridDecimator decimator;
+	CalibrateAccelerometer calibrate;
+	if(calibrate.set_parameters(decimator.decimate(data.accel_vectors()))){
+		calibrate.evaluate();
+		res.accel_sphere = calibrate.result();
+	}
+
+	return res;
+}
+
+void LogAnalyzer::set_threads(int value)
+{
+	m_threads = qMax(1, value);
+}
+
+int LogAnalyzer::threads() const
+{
+	return m_threads;
+}
+
+void LogAnalyzer::set_calibration(const QString &value)
+{
+	m_calibration = value;
+}
+
+QString LogAnalyzer::calibration() const
+{
+	return m_calibration;
+}
+
+QVector<LogSummary> LogAnalyzer::analyze(const QStringList &files)
+{
+	QVector< LogSummary > res(files.size());
+	QMutex output;
+	int done = 0;
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(m_threads);
+	for(int i = 0; i < files.size(); i++){
+		pool.start(new AnalyzeRunnable(files[i], m_calibration, &res[i], &output, &done, files.size()));
+	}
+	pool.waitForDone();
+
+	return res;
+}
+
+bool LogAnalyzer::write_report(const QString &fileName, const QVector<LogSummary> &summaries)
+{
+	QFile file;
+	if(fileName.isEmpty()){
+		if(!file.open(stdout, QIODevice::WriteOnly))
+			return false;
+	}else{
+		file.setFileName(fileName);
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+	}
+
+	QTextStream stream(&file);
+	stream.setRealNumberPrecision(10);
+
+	if(fileName.endsWith(".json", Qt::CaseInsensitive)){
+		stream << "[\n";
+		for(int i = 0; i < summaries.size(); i++){
+			const LogSummary& s = summaries[i];
+			stream << "  {\"file\": " << json_string(s.file);
+			if(!s.error.isEmpty()){
+				stream << ", \"error\": " << json_string(s.error);
+			}
+			stream << ", \"samples\": " << s.samples << ", \"duration\": " << s.duration
+				   << ", \"rate\": " << s.rate << ", \"gaps\": " << s.gaps << ", \"max_gap\": " << s.max_gap;
+			if(s.has_gyro_bias){
+				stream << ", \"gyro_bias\": [" << s.gyro_bias.x() << ", " << s.gyro_bias.y() << ", " << s.gyro_bias.z() << "]";
+			}
+			if(!s.accel_sphere.empty()){
+				stream << ", \"accel_sphere\": {\"center\": [" << s.accel_sphere.cp.x() << ", " << s.accel_sphere.cp.y() << ", "
+					   << s.accel_sphere.cp.z() << "], \"radius\": " << s.accel_sphere.mean_radius
+					   << ", \"deviation\": " << s.accel_sphere.deviation << "}";
+			}
+			if(s.has_attitude){
+				stream << ", \"attitude_min\": [" << s.attitude_min.x() << ", " << s.attitude_min.y() << ", " << s.attitude_min.z() << "]"
+					   << ", \"attitude_max\": [" << s.attitude_max.x() << ", " << s.attitude_max.y() << ", " << s.attitude_max.z() << "]";
+			}
+			stream << "}" << (i + 1 < summaries.size()? ",\n" : "\n");
+		}
+		stream << "]\n";
+		return true;
+	}
+
+	stream << "file;error;samples;duration;rate;gaps;max_gap;"
+			  "gyro_bias_x;gyro_bias_y;gyro_bias_z;"
+			  "sphere_x;sphere_y;sphere_z;sphere_radius;sphere_deviation;"
+			  "roll_min;pitch_min;yaw_min;roll_max;pitch_max;yaw_max\n";
+	foreach (const LogSummary& s, summaries) {
+		stream << csv_string(s.file) << ";" << csv_string(s.error) << ";" << s.samples << ";" << s.duration << ";" << s.rate << ";"
+			   << s.gaps << ";" << s.max_gap << ";";
+		if(s.has_gyro_bias)
+			stream << s.gyro_bias.x() << ";" << s.gyro_bias.y() << ";" << s.gyro_bias.z() << ";";
+		else
+			stream << ";;;";
+		if(!s.accel_sphere.empty())
+			stream << s.accel_sphere.cp.x() << ";" << s.accel_sphere.cp.y() << ";" << s.accel_sphere.cp.z() << ";"
+				   << s.accel_sphere.mean_radius << ";" << s.accel_sphere.deviation << ";";
+		else
+			stream << ";;;;;";
+		if(s.has_attitude)
+			stream << s.attitude_min.x() << ";" << s.attitude_min.y() << ";" << s.attitude_min.z() << ";"
+				   << s.attitude_max.x() << ";" << s.attitude_max.y() << ";" << s.attitude_max.z();
+		else
+			stream << ";;;;;";
+		stream << "\n";
+	}
+	return true;
+}
+
+int LogAnalyzer::exec(const QStringList &arguments)
+{
+	QString path, report;
+	LogAnalyzer analyzer;
+
+	for(int i = 1; i < arguments.size(); i++){
+		const QString& arg = arguments[i];
+		if(arg == "--analyze" && i + 1 < arguments.size()){
+			path = arguments[++i];
+		}else if(arg == "--report" && i + 1 < arguments.size()){
+			report = arguments[++i];
+		}else if(arg == "--threads" && i + 1 < arguments.size()){
+			analyzer.set_threads(arguments[++i].toInt());
+		}else if(arg == "--calibration" && i + 1 < arguments.size()){
+			analyzer.set_calibration(arguments[++i]);
+		}
+	}
+
+	QTextStream err(stderr);
+	if(path.isEmpty()){
+		err << "usage: --analyze <dir|glob> [--report <file.csv|file.json>] [--threads N] [--calibration <file>]\n";
+		return 1;
+	}
+	if(!analyzer.calibration().isEmpty() && !QFileInfo(analyzer.calibration()).isFile()){
+		err << "no calibration: " << analyzer.calibration() << "\n";
+		return 1;
+	}
+
+	QStringList files = collect(path);
+	if(files.isEmpty()){
+		err << "no logs: " << path << "\n";
+		return 1;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QVector< LogSummary > summaries = analyzer.analyze(files);
+
+	err << files.size() << " logs analyzed in " << timer.elapsed() / 1000. << " s with "
+		<< analyzer.threads() << " threads\n";
+	err.flush();
+
+	if(!write_report(report, summaries)){
+		err << "report not written: " << report << "\n";
+		return 1;
+	}
+
+	int failed = 0;
+	foreach (const LogSummary& s, summaries) {
+		if(!s.error.isEmpty())
+			failed++;
+	}
+	return failed == summaries.size()? 1 : 0;
+}
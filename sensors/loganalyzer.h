@@ -0,0 +1,105 @@
+#ifndef LOGANALYZER_H
+#define LOGANALYZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <struct_controls.h>
+
+#include "calibrateaccelerometer.h"
+
+/**
+ * @brief The LogSummary struct
+ * statistics of one log after the orientation pipeline
+ */
+struct LogSummary{
+	LogSummary();
+
+	QString file;
+	/// empty if the log is analyzed
+	QString error;
+
+	qint64 samples;
+	/// seconds between the first and the last tick
+	double duration;
+	/// samples per second
+	double rate;
+	/// count of intervals between ticks longer than two periods
+	qint64 gaps;
+	/// the longest interval between ticks, ms
+	double max_gap;
+
+	bool has_gyro_bias;
+	vector3_::Vector3d gyro_bias;
+	StructMeanSphere accel_sphere;
+
+	/// roll, pitch, yaw in degrees after the pipeline is calculated
+	bool has_attitude;
+	vector3_::Vector3d attitude_min;
+	vector3_::Vector3d attitude_max;
+};
+
+/**
+ * @brief The LogAnalyzer class
+ * headless analysis of logs: each log goes through SensorsWork::analyze_telemetry
+ * in own task of the pool, results are written to one csv or json report.
+ * the pipeline starts from the default calibration or from the given file, not from calibrate.xml
+ * of the application, so reports do not depend on the machine
+ */
+class LogAnalyzer
+{
+public:
+	LogAnalyzer();
+
+	/**
+	 * @brief collect
+	 * logs in the directory or files matched by the glob
+	 * @param path - directory or glob
+	 * @return
+	 */
+	static QStringList collect(const QString& path);
+	/**
+	 * @brief analyze_file
+	 * the pipeline for one log. may be called from any thread
+	 * @param fileName
+	 * @param calibration - file of the calibration or empty for the default one
+	 * @return
+	 */
+	static LogSummary analyze_file(const QString& fileName, const QString& calibration = QString());
+
+	void set_threads(int value);
+	int threads() const;
+	void set_calibration(const QString& value);
+	QString calibration() const;
+	/**
+	 * @brief analyze
+	 * analyze logs in the pool
+	 * @param files
+	 * @return summaries in order of files
+	 */
+	QVector< LogSummary > analyze(const QStringList& files);
+
+	/**
+	 * @brief write_report
+	 * report in json if the name ends with .json, otherwise in csv. empty name is stdout
+	 * @param fileName
+	 * @param summaries
+	 * @return
+	 */
+	static bool write_report(const QString& fileName, const QVector< LogSummary >& summaries);
+
+	/**
+	 * @brief exec
+	 * command line: --analyze <dir|glob> [--report <file.csv|file.json>] [--threads N] [--calibration <file>]
+	 * @param arguments - arguments of the application
+	 * @return exit code
+	 */
+	static int exec(const QStringList& arguments);
+
+private:
+	int m_threads;
+	QString m_calibration;
+};
+
+#endif // LOGANALYZER_H
@@ -0,0 +1,194 @@
+#include "pointcloudlod.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace vector3_;
+
+/// bits for the index of the cell along one axis
+const int cell_bits = 21;
+
+PointCloudLod::PointCloudLod()
+	: m_size(0)
+{
+}
+
+void PointCloudLod::build(const QVector<Vector3d> &points, const std::atomic<bool> *cancel)
+{
+	clear();
+	if(points.isEmpty())
+		return;
+
+	Vector3d min_pt = points[0], max_pt = points[0];
+	foreach (const Vector3d& v, points) {
+		for(int j = 0; j < 3; j++){
+			min_pt.data[j] = qMin(min_pt.data[j], v.data[j]);
+			max_pt.data[j] = qMax(max_pt.data[j], v.data[j]);
+		}
+	}
+	double extent = 0;
+	for(int j = 0; j < 3; j++){
+		extent = qMax(extent, max_pt.data[j] - min_pt.data[j]);
+	}
+	if(extent <= 0)
+		extent = 1;
+
+	QSet< quint64 > cells;
+	QVector< Level > levels;
+	const quint64 max_index = (1 << cell_bits) - 1;
+
+	for(int k = 0; k < max_levels; k++){
+		Level level;
+		level.cell = extent / (base_cells << k);
+		const double inv_cell = 1. / level.cell;
+
+		cells.clear();
+		for(int i = 0; i < points.size(); i++){
+			if(cancel && i % 65536 == 0 && *cancel)
+				return;
+
+			const Vector3d& v = points[i];
+			quint64 key = 0;
+			for(int j = 0; j < 3; j++){
+				quint64 c = qMin< quint64 >(max_index, (quint64)((v.data[j] - min_pt.data[j]) * inv_cell));
+				key = (key << cell_bits) | c;
+			}
+			if(!cells.contains(key)){
+				cells.insert(key);
+				level.indices.push_back(i);
+			}
+		}
+
+		/// the level close to the whole cloud gives nothing
+		if(level.indices.size() * 2 > points.size())
+			break;
+		levels.push_back(level);
+	}
+
+	m_levels = levels;
+	m_size = points.size();
+}
+
+void PointCloudLod::clear()
+{
+	m_levels.clear();
+	m_size = 0;
+}
+
+bool PointCloudLod::empty() const
+{
+	return m_levels.isEmpty();
+}
+
+int PointCloudLod::size() const
+{
+	return m_size;
+}
+
+int PointCloudLod::count_levels() const
+{
+	return m_levels.size();
+}
+
+const PointCloudLod::Level &PointCloudLod::level(int index) const
+{
+	return m_levels[index];
+}
+
+int PointCloudLod::prefix(int level, int count) const
+{
+	const QVector< quint32 >& indices = m_levels[level].indices;
+	return std::lower_bound(indices.begin(), indices.end(), (quint32)qMax(0, count)) - indices.begin();
+}
+
+int PointCloudLod::select(double max_cell, int count, int budget) const
+{
+	int res = -1;
+	for(int i = 0; i < m_levels.size(); i++){
+		if(m_levels[i].cell <= max_cell){
+			res = i;
+			break;
+		}
+	}
+
+	if(res < 0){
+		if(count <= budget || m_levels.isEmpty())
+			return -1;
+		res = m_levels.size() - 1;
+	}
+	while(res > 0 && prefix(res, count) > budget){
+		res--;
+	}
+	return res;
+}
+
+/////////////////////////////////
+
+PointCloudLodBuilder::PointCloudLodBuilder(QObject *parent)
+	: QThread(parent)
+	, m_cancel(false)
+	, m_ready(false)
+{
+}
+
+PointCloudLodBuilder::~PointCloudLodBuilder()
+{
+	cancel();
+}
+
+void PointCloudLodBuilder::build(const TelemetryColumns &data)
+{
+	cancel();
+
+	m_data = data;
+	m_cancel = false;
+	m_ready = false;
+
+	start(QThread::LowPriority);
+}
+
+void PointCloudLodBuilder::cancel()
+{
+	m_cancel = true;
+	wait();
+
+	m_data.clear();
+	QMutexLocker lock(&m_mutex);
+	m_ready = false;
+}
+
+bool PointCloudLodBuilder::take(PointCloudLod &accel, PointCloudLod &gyro, PointCloudLod &compass)
+{
+	QMutexLocker lock(&m_mutex);
+	if(!m_ready)
+		return false;
+
+	accel = m_accel;
+	gyro = m_gyro;
+	compass = m_compass;
+	m_accel.clear();
+	m_gyro.clear();
+	m_compass.clear();
+	m_ready = false;
+	return true;
+}
+
+void PointCloudLodBuilder::run()
+{
+	PointCloudLod accel, gyro, compass;
+
+	accel.build(m_data.accel_vectors(), &m_cancel);
+	gyro.build(m_data.gyro_vectors(), &m_cancel);
+	compass.build(m_data.compass_vectors(), &m_cancel);
+
+	if(m_cancel)
+		return;
+
+	QMutexLocker lock(&m_mutex);
+	m_accel = accel;
+	m_gyro = gyro;
+	m_compass = compass;
+	m_ready = true;
+}
@@ -0,0 +1,118 @@
+#ifndef POINTCLOUDLOD_H
+#define POINTCLOUDLOD_H
+
+#include <QVector>
+#include <QThread>
+#include <QMutex>
+
+#include <atomic>
+
+#include "struct_controls.h"
+#include "telemetrycolumns.h"
+
+/**
+ * @brief The PointCloudLod class
+ * levels of detail of one point cloud. level k keeps the first sample of each cell
+ * of the grid with the cell size extent / (base_cells * 2^k), so each level covers the cloud evenly.
+ * indices of each level are ascending, the shown prefix of samples is the prefix of the level
+ */
+class PointCloudLod
+{
+public:
+	enum{
+		/// count of cells along the largest side of the bounding box on the coarsest level
+		base_cells = 16,
+		max_levels = 12
+	};
+
+	struct Level{
+		Level(): cell(0) {}
+
+		/// size of the cell in units of points
+		double cell;
+		QVector< quint32 > indices;
+	};
+
+	PointCloudLod();
+
+	/**
+	 * @brief build
+	 * levels are built from coarse to fine while a level is less than a half of the cloud
+	 * @param points
+	 * @param cancel - stop the build if set
+	 */
+	void build(const QVector< vector3_::Vector3d >& points, const std::atomic< bool >* cancel = 0);
+	void clear();
+	bool empty() const;
+	/**
+	 * @brief size
+	 * @return count of points of the cloud
+	 */
+	int size() const;
+	int count_levels() const;
+	const Level& level(int index) const;
+	/**
+	 * @brief prefix
+	 * @param level
+	 * @param count - count of shown samples of the cloud
+	 * @return count of indices of the level for these samples
+	 */
+	int prefix(int level, int count) const;
+	/**
+	 * @brief select
+	 * the coarsest level with the cell not larger than max_cell,
+	 * then coarser levels while the level has more points than the budget
+	 * @param max_cell - size of the cell in units of points that is not seen on the screen
+	 * @param count - count of shown samples of the cloud
+	 * @param budget - maximum count of drawn points
+	 * @return index of the level or -1 for the whole cloud
+	 */
+	int select(double max_cell, int count, int budget) const;
+
+private:
+	int m_size;
+	QVector< Level > m_levels;
+};
+
+/**
+ * @brief The PointCloudLodBuilder class
+ * build of levels of the accelerometer, gyroscope and compass clouds of the telemetry
+ * in the background thread. finished() of the thread is emitted at the end
+ */
+class PointCloudLodBuilder : public QThread
+{
+public:
+	explicit PointCloudLodBuilder(QObject* parent = 0);
+	~PointCloudLodBuilder();
+
+	/**
+	 * @brief build
+	 * cancel the current build and start the new one. the data is shared, not copied
+	 * @param data
+	 */
+	void build(const TelemetryColumns& data);
+	void cancel();
+	/**
+	 * @brief take
+	 * @param accel
+	 * @param gyro
+	 * @param compass
+	 * @return false if the build is not finished or is cancelled
+	 */
+	bool take(PointCloudLod& accel, PointCloudLod& gyro, PointCloudLod& compass);
+
+protected:
+	virtual void run();
+
+private:
+	TelemetryColumns m_data;
+	std::atomic< bool > m_cancel;
+
+	QMutex m_mutex;
+	bool m_ready;
+	PointCloudLod m_accel;
+	PointCloudLod m_gyro;
+	PointCloudLod m_compass;
+};
+
+#endif // POINTCLOUDLOD_H
@@ -0,0 +1,52 @@
+#include "replaycheckpoints.h"
+
+ReplayCheckpoints::ReplayCheckpoints(int interval)
+	: m_interval(qMax(1, interval))
+{
+}
+
+void ReplayCheckpoints::set_interval(int value)
+{
+	m_interval = qMax(1, value);
+	m_checkpoints.clear();
+}
+
+int ReplayCheckpoints::interval() const
+{
+	return m_interval;
+}
+
+bool ReplayCheckpoints::is_due(qint64 index, qint64 tick) const
+{
+	/// the log without ticks can not be sought by tick
+	if(!tick || index % m_interval)
+		return false;
+	return !m_checkpoints.contains(tick);
+}
+
+void ReplayCheckpoints::add(qint64 index, qint64 tick, const SensorsWork::State &state)
+{
+	ReplayCheckpoint& cp = m_checkpoints[tick];
+	cp.index = index;
+	cp.tick = tick;
+	cp.state = state;
+}
+
+const ReplayCheckpoint *ReplayCheckpoints::nearest(qint64 tick) const
+{
+	QMap< qint64, ReplayCheckpoint >::const_iterator it = m_checkpoints.upperBound(tick);
+	if(it == m_checkpoints.constBegin())
+		return 0;
+	--it;
+	return &it.value();
+}
+
+void ReplayCheckpoints::clear()
+{
+	m_checkpoints.clear();
+}
+
+int ReplayCheckpoints::size() const
+{
+	return m_checkpoints.size();
+}
@@ -0,0 +1,64 @@
+#ifndef REPLAYCHECKPOINTS_H
+#define REPLAYCHECKPOINTS_H
+
+#include <QMap>
+
+#include "sensorswork.h"
+
+/**
+ * @brief The ReplayCheckpoint struct
+ * state of the pipeline before the sample
+ */
+struct ReplayCheckpoint{
+	ReplayCheckpoint(): index(0), tick(0) {}
+
+	/// count of samples played before the checkpoint
+	qint64 index;
+	/// gyroscope.tick of the sample
+	qint64 tick;
+	SensorsWork::State state;
+};
+
+/**
+ * @brief The ReplayCheckpoints class
+ * checkpoints of the pipeline saved every interval samples of the replay.
+ * the seek restores the nearest checkpoint before the target and replays
+ * at most interval samples instead of the whole log
+ */
+class ReplayCheckpoints
+{
+public:
+	enum{
+		/// the trail of SensorsWork is refilled after the restore
+		default_interval = max_count_telemetry
+	};
+
+	explicit ReplayCheckpoints(int interval = default_interval);
+
+	void set_interval(int value);
+	int interval() const;
+	/**
+	 * @brief is_due
+	 * @param index - count of played samples
+	 * @param tick - tick of the next sample
+	 * @return true if the checkpoint before the sample is needed
+	 */
+	bool is_due(qint64 index, qint64 tick) const;
+	void add(qint64 index, qint64 tick, const SensorsWork::State& state);
+	/**
+	 * @brief nearest
+	 * @param tick
+	 * @return the last checkpoint at or before the tick or null
+	 */
+	const ReplayCheckpoint* nearest(qint64 tick) const;
+
+	void clear();
+	int size() const;
+
+private:
+	int m_interval;
+	/// by tick
+	QMap< qint64, ReplayCheckpoint > m_checkpoints;
+};
+
+#endif // REPLAYCHECKPOINTS_H
@@ -0,0 +1,178 @@
+#include "replayengine.h"
+
+#include <global.h>
+
+#include "replaysource.h"
+
+using namespace sc;
+
+/// longer gaps between samples are replaced by the period of the gyroscope, ms
+const double max_gap = 1000;
+/// period when the sample has no tick, ms
+const double default_period = 10;
+/// the replay slows down if it lags behind the clock more than this, ms of the log
+const double max_lag = 200;
+/// maximum time of playing for one wakeup, ms
+const qint64 max_work_time = 20;
+/// interval of wakeups, ms
+const int wakeup_interval = 1;
+
+ReplayEngine::ReplayEngine(ReplaySource *source, QObject *parent)
+	: QObject(parent)
+	, m_source(source)
+	, m_last_wakeup(0)
+	, m_speed(1)
+	, m_unthrottled(false)
+	, m_running(false)
+	, m_log_clock(0)
+	, m_pending_time(0)
+	, m_has_pending(false)
+	, m_prev_tick(0)
+	, m_has_prev(false)
+	, m_fast_forward_tick(0)
+{
+#ifdef QT5
+	m_timer.setTimerType(Qt::PreciseTimer);
+#endif
+	connect(&m_timer, SIGNAL(timeout()), this, SLOT(_on_timeout()));
+	m_clock.start();
+}
+
+void ReplayEngine::start()
+{
+	if(m_running)
+		return;
+	m_running = true;
+	m_last_wakeup = m_clock.nsecsElapsed();
+	m_timer.start(m_unthrottled? 0 : wakeup_interval);
+}
+
+void ReplayEngine::pause()
+{
+	m_running = false;
+	m_timer.stop();
+}
+
+bool ReplayEngine::is_running() const
+{
+	return m_running;
+}
+
+void ReplayEngine::reset_clock()
+{
+	m_has_pending = false;
+	m_has_prev = false;
+	m_log_clock = 0;
+	m_pending_time = 0;
+	m_last_wakeup = m_clock.nsecsElapsed();
+	m_fast_forward_tick = 0;
+}
+
+void ReplayEngine::fast_forward(qint64 tick)
+{
+	m_fast_forward_tick = tick;
+	if(m_running)
+		m_timer.start(0);
+}
+
+bool ReplayEngine::is_fast_forward() const
+{
+	return m_fast_forward_tick != 0;
+}
+
+void ReplayEngine::set_speed(double value)
+{
+	m_speed = qBound(0.1, value, 100.);
+}
+
+double ReplayEngine::speed() const
+{
+	return m_speed;
+}
+
+void ReplayEngine::set_unthrottled(bool value)
+{
+	m_unthrottled = value;
+	if(m_running)
+		m_timer.start(m_unthrottled? 0 : wakeup_interval);
+}
+
+bool ReplayEngine::is_unthrottled() const
+{
+	return m_unthrottled;
+}
+
+void ReplayEngine::_on_timeout()
+{
+	QElapsedTimer work;
+	work.start();
+
+	qint64 now = m_clock.nsecsElapsed();
+	m_log_clock += (now - m_last_wakeup) / 1e6 * m_speed;
+	m_last_wakeup = now;
+
+	int count = 0;
+	while(m_running){
+		if(!m_has_pending){
+			if(!m_source->next(m_pending)){
+				if(m_source->at_end()){
+					pause();
+					emit finished();
+				}
+				break;
+			}
+			m_has_pending = true;
+
+			if(m_fast_forward_tick && m_pending.gyroscope.tick >= m_fast_forward_tick){
+				/// the target of the seek is reached: the time of the log starts from it
+				m_fast_forward_tick = 0;
+				m_has_prev = false;
+				m_log_clock = 0;
+				m_last_wakeup = m_clock.nsecsElapsed();
+				if(!m_unthrottled)
+					m_timer.start(wakeup_interval);
+			}
+			schedule(m_pending);
+		}
+
+		if(!m_unthrottled && !m_fast_forward_tick && m_pending_time > m_log_clock)
+			break;
+
+		m_has_pending = false;
+		emit play_sample(m_pending);
+
+		/// the gui stays alive when many samples are due
+		if(++count % 64 == 0 && work.elapsed() >= max_work_time)
+			break;
+	}
+
+	if(m_unthrottled){
+		/// the clock follows played samples
+		m_log_clock = m_pending_time;
+	}else if(m_log_clock - m_pending_time > max_lag){
+		/// playing does not keep up: the replay slows down instead of the burst
+		m_log_clock = m_pending_time + max_lag;
+	}
+}
+
+void ReplayEngine::schedule(const StructTelemetry &st)
+{
+	const qint64 tick = st.gyroscope.tick;
+	const double period = st.gyroscope.freq > 0? 1000. / st.gyroscope.freq : default_period;
+
+	if(!m_has_prev){
+		/// the first sample after the reset is due at once
+		m_pending_time = m_log_clock;
+	}else{
+		double delta = period;
+		if(tick && m_prev_tick){
+			delta = tick - m_prev_tick;
+			if(delta < 0 || delta > max_gap)
+				delta = period;
+		}
+		m_pending_time += delta;
+	}
+
+	m_prev_tick = tick;
+	m_has_prev = true;
+}
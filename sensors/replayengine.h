@@ -0,0 +1,87 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <struct_controls.h>
+
+class ReplaySource;
+
+/**
+ * @brief The ReplayEngine class
+ * replay of samples from the source in the time of the log.
+ * each sample is due after the delta of gyroscope.tick from the previous one multiplied by 1/speed.
+ * on each wakeup all due samples are played, so the rate of the log does not depend on the timer.
+ * in the unthrottled mode samples are played as fast as possible
+ */
+class ReplayEngine : public QObject
+{
+	Q_OBJECT
+public:
+	explicit ReplayEngine(ReplaySource* source, QObject *parent = 0);
+
+	void start();
+	void pause();
+	bool is_running() const;
+	/**
+	 * @brief reset_clock
+	 * start the time of the replay from the next sample. call after the seek
+	 */
+	void reset_clock();
+	/**
+	 * @brief fast_forward
+	 * samples before the tick are played at once without the time of the log,
+	 * the normal playing continues from the first sample at or after the tick.
+	 * used to catch up the pipeline from the checkpoint after the seek
+	 * @param tick
+	 */
+	void fast_forward(qint64 tick);
+	bool is_fast_forward() const;
+
+	/**
+	 * @brief set_speed
+	 * @param value - multiplier of the time of the log [0.1, 100]
+	 */
+	void set_speed(double value);
+	double speed() const;
+	void set_unthrottled(bool value);
+	bool is_unthrottled() const;
+
+signals:
+	void play_sample(const sc::StructTelemetry& st);
+	/**
+	 * @brief finished
+	 * all samples of the source are played, the engine is paused
+	 */
+	void finished();
+
+private slots:
+	void _on_timeout();
+
+private:
+	ReplaySource* m_source;
+	QTimer m_timer;
+	QElapsedTimer m_clock;
+	qint64 m_last_wakeup;
+
+	double m_speed;
+	bool m_unthrottled;
+	bool m_running;
+
+	/// time of the log reached by the clock, ms
+	double m_log_clock;
+	/// time of the log of the pending sample, ms
+	double m_pending_time;
+	sc::StructTelemetry m_pending;
+	bool m_has_pending;
+	qint64 m_prev_tick;
+	bool m_has_prev;
+	/// 0 if samples are played in the time of the log
+	qint64 m_fast_forward_tick;
+
+	void schedule(const sc::StructTelemetry& st);
+};
+
+#endif // REPLAYENGINE_H
@@ -0,0 +1,587 @@
+#include "replaysource.h"
+
+#include <QFileInfo>
+#include <QRegExp>
+
+#include <algorithm>
+#include <string.h>
+
+#include "telemetryloader.h"
+#include "telemetrycompression.h"
+
+using namespace sc;
+
+/// size of the piece of the csv read at once
+const qint64 csv_piece_size = 256 * 1024;
+/// count of binary records read at once
+const int binary_piece_records = 4096;
+/// minimal distance between collected points of the index
+const qint64 point_interval = 1024 * 1024;
+/// bisection stops on this size, the rest is skipped by reading
+const qint64 bisect_size = 64 * 1024;
+/// size of the head of the file with the header of the log
+const int head_size = 64 * 1024;
+
+static bool point_less(const LogIndexPoint& a, const LogIndexPoint& b)
+{
+	return a.offset < b.offset;
+}
+
+/**
+ * @brief session_index
+ * the index of the session for the chunk: the first chunk has the name of the session,
+ * next ones have the suffix _NNN
+ */
+static QString session_index(const QString& fileName)
+{
+	QFileInfo fi(fileName);
+	QString base = fi.path() + "/" + fi.completeBaseName();
+	if(!QFile::exists(base + LogIndex::extension()))
+		base.remove(QRegExp("_\\d{3}$"));
+	return base + LogIndex::extension();
+}
+
+////////////////////////////////
+
+ReplaySource::ReplaySource(QObject *parent)
+	: QThread(parent)
+	, m_format(TelemetryFormat::CSV)
+	, m_codec(0)
+	, m_size(0)
+	, m_window_size(default_window)
+	, m_eof(false)
+	, m_stop(false)
+	, m_generation(0)
+	, m_seek_type(SeekPercent)
+	, m_seek_percent(0)
+	, m_seek_tick(0)
+	, m_position(0)
+	, m_file_chunk(-1)
+{
+}
+
+ReplaySource::~ReplaySource()
+{
+	close();
+}
+
+bool ReplaySource::open(const QString &fileName)
+{
+	close();
+	m_error.clear();
+
+	QVector< LogIndexChunk > index_chunks;
+	LogIndex index;
+
+	if(fileName.endsWith(LogIndex::extension())){
+		if(!index.load(fileName)){
+			m_error = "empty index of the session";
+			return false;
+		}
+		index_chunks = index.chunks();
+		for(int i = 0; i < index_chunks.size(); i++){
+			index_chunks[i].file = index.chunk_path(i);
+		}
+	}else{
+		LogIndexChunk chunk;
+		chunk.file = fileName;
+		/// points of the chunk from the index of its session
+		if(index.load(session_index(fileName))){
+			QString name = QFileInfo(fileName).fileName();
+			foreach (const LogIndexChunk& it, index.chunks()) {
+				if(it.file == name){
+					chunk = it;
+					chunk.file = fileName;
+					break;
+				}
+			}
+		}
+		index_chunks.push_back(chunk);
+	}
+
+	m_size = 0;
+	for(int i = 0; i < index_chunks.size(); i++){
+		const LogIndexChunk& ic = index_chunks[i];
+
+		QFile file(ic.file);
+		if(!file.open(QIODevice::ReadOnly)){
+			m_error = ic.file + ": " + file.errorString();
+			m_chunks.clear();
+			return false;
+		}
+		QByteArray head = file.read(head_size);
+
+		Chunk chunk;
+		chunk.path = ic.file;
+		chunk.base = m_size;
+		chunk.size = file.size();
+		chunk.points = ic.points;
+		chunk.first_tick = ic.first_tick;
+		chunk.has_first_tick = ic.count > 0;
+		std::sort(chunk.points.begin(), chunk.points.end(), point_less);
+
+		TelemetrySchema schema;
+		int codec = 0;
+		if((chunk.header_size = TelemetryFormat::read_header(head.constData(), head.size(), schema)) && schema.is_valid()){
+			m_format = TelemetryFormat::Binary;
+		}else if((chunk.header_size = TelemetryCompression::read_header(head.constData(), head.size(), schema, codec)) && schema.is_valid()){
+			m_format = TelemetryFormat::Compressed;
+			if(!TelemetryCompression::is_codec_supported(codec)){
+				m_error = "codec " + QString::number(codec) + " of the compressed log is not supported";
+				m_chunks.clear();
+				return false;
+			}
+		}else{
+			m_format = TelemetryFormat::CSV;
+			chunk.header_size = 0;
+		}
+		m_schema = schema;
+		m_codec = codec;
+
+		m_size += chunk.size;
+		m_chunks.push_back(chunk);
+	}
+
+	m_window.clear();
+	m_eof = false;
+	m_stop = false;
+	m_generation = 0;
+	m_seek_type = SeekPercent;
+	m_seek_percent = 0;
+	m_position = 0;
+
+	start();
+	return true;
+}
+
+void ReplaySource::close()
+{
+	m_mutex.lock();
+	m_stop = true;
+	m_cond.wakeAll();
+	m_mutex.unlock();
+
+	wait();
+
+	m_chunks.clear();
+	m_window.clear();
+	m_size = 0;
+	m_position = 0;
+}
+
+bool ReplaySource::is_open() const
+{
+	return !m_chunks.empty();
+}
+
+TelemetryFormat::Format ReplaySource::format() const
+{
+	return m_format;
+}
+
+QString ReplaySource::error() const
+{
+	return m_error;
+}
+
+qint64 ReplaySource::size() const
+{
+	return m_size;
+}
+
+bool ReplaySource::next(StructTelemetry &st)
+{
+	QMutexLocker lock(&m_mutex);
+
+	if(m_window.empty())
+		return false;
+
+	st = m_window.front().st;
+	m_position = m_window.front().position;
+	m_window.pop_front();
+
+	/// the reader waits until the window is half empty
+	if((int)m_window.size() < m_window_size / 2)
+		m_cond.wakeAll();
+	return true;
+}
+
+bool ReplaySource::at_end() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_eof && m_window.empty();
+}
+
+int ReplaySource::buffered() const
+{
+	QMutexLocker lock(&m_mutex);
+	return (int)m_window.size();
+}
+
+void ReplaySource::set_window(int samples)
+{
+	QMutexLocker lock(&m_mutex);
+	m_window_size = qMax(samples, 2);
+	m_cond.wakeAll();
+}
+
+int ReplaySource::window() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_window_size;
+}
+
+void ReplaySource::seek_percent(double percent)
+{
+	QMutexLocker lock(&m_mutex);
+
+	percent = qBound(0., percent, 100.);
+	m_generation++;
+	m_seek_type = SeekPercent;
+	m_seek_percent = percent;
+	m_window.clear();
+	m_eof = false;
+	m_position = m_size * percent / 100.;
+	m_cond.wakeAll();
+}
+
+void ReplaySource::seek_tick(qint64 tick)
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_generation++;
+	m_seek_type = SeekTick;
+	m_seek_tick = tick;
+	m_window.clear();
+	m_eof = false;
+	m_cond.wakeAll();
+}
+
+double ReplaySource::percent_position() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_size? 100. * m_position / m_size : 0;
+}
+
+void ReplaySource::run()
+{
+	int generation = -1;
+	int chunk = 0;
+	qint64 offset = 0;
+	qint64 skip_tick = 0;
+	bool skip = false;
+	QVector< Sample > samples;
+
+	forever{
+		bool seek = false;
+		SeekType seek_type = SeekPercent;
+		double seek_percent = 0;
+		qint64 seek_tick = 0;
+
+		m_mutex.lock();
+		while(!m_stop && generation == m_generation && (m_eof || (int)m_window.size() >= m_window_size))
+			m_cond.wait(&m_mutex);
+		if(m_stop){
+			m_mutex.unlock();
+			break;
+		}
+		if(generation != m_generation){
+			generation = m_generation;
+			seek = true;
+			seek_type = m_seek_type;
+			seek_percent = m_seek_percent;
+			seek_tick = m_seek_tick;
+		}
+		m_mutex.unlock();
+
+		if(seek){
+			if(seek_type == SeekPercent){
+				resolve_percent(seek_percent, chunk, offset);
+				skip = false;
+			}else{
+				resolve_tick(seek_tick, chunk, offset);
+				skip = true;
+				skip_tick = seek_tick;
+			}
+		}
+
+		samples.resize(0);
+		if(chunk < m_chunks.size()){
+			Chunk& c = m_chunks[chunk];
+			offset = read_piece(chunk, offset, samples);
+			if(!samples.empty())
+				add_point(c, samples.front().st.gyroscope.tick, samples.front().position - c.base);
+
+			if(offset >= c.size){
+				chunk++;
+				if(chunk < m_chunks.size())
+					offset = m_chunks[chunk].header_size;
+			}
+		}
+		bool eof = chunk >= m_chunks.size();
+
+		m_mutex.lock();
+		if(generation == m_generation){
+			foreach (const Sample& sample, samples) {
+				/// samples before the tick of the seek
+				if(skip && sample.st.gyroscope.tick < skip_tick)
+					continue;
+				skip = false;
+				m_window.push_back(sample);
+			}
+			m_eof = eof;
+		}
+		m_mutex.unlock();
+	}
+
+	m_file.close();
+	m_file_chunk = -1;
+}
+
+QByteArray ReplaySource::read_at(int chunk, qint64 offset, qint64 len)
+{
+	if(m_file_chunk != chunk){
+		m_file.close();
+		m_file.setFileName(m_chunks[chunk].path);
+		m_file_chunk = m_file.open(QIODevice::ReadOnly)? chunk : -1;
+	}
+	if(m_file_chunk != chunk || !m_file.seek(offset))
+		return QByteArray();
+	return m_file.read(len);
+}
+
+qint64 ReplaySource::align(int chunk, qint64 offset, qint64 from)
+{
+	const Chunk& c = m_chunks[chunk];
+
+	if(offset <= c.header_size)
+		return c.header_size;
+	if(offset >= c.size)
+		return c.size;
+
+	switch (m_format) {
+	case TelemetryFormat::Binary:
+	{
+		const int rs = m_schema.record_size;
+		qint64 pos = c.header_size + (offset - c.header_size + rs - 1) / rs * rs;
+		return qMin(pos, c.size);
+	}
+	case TelemetryFormat::Compressed:
+	{
+		/// walk by headers of blocks from the known block
+		qint64 pos = qMax< qint64 >(from, c.header_size);
+		TelemetryBlockHeader header;
+		while(pos < offset){
+			QByteArray data = read_at(chunk, pos, TelemetryCompression::block_header_size);
+			if(!TelemetryCompression::read_block_header(data.constData(), data.size(), header))
+				return c.size;
+			pos += TelemetryCompression::block_header_size + header.size;
+		}
+		return qMin(pos, c.size);
+	}
+	default:
+	{
+		/// the start of the next line
+		qint64 pos = offset - 1;
+		while(pos < c.size){
+			QByteArray data = read_at(chunk, pos, csv_piece_size);
+			if(data.isEmpty())
+				return c.size;
+			int nl = data.indexOf('\n');
+			if(nl >= 0)
+				return pos + nl + 1;
+			pos += data.size();
+		}
+		return c.size;
+	}
+	}
+}
+
+bool ReplaySource::probe(int chunk, qint64 offset, qint64 &tick)
+{
+	switch (m_format) {
+	case TelemetryFormat::Compressed:
+	{
+		TelemetryBlockHeader header;
+		QByteArray data = read_at(chunk, offset, TelemetryCompression::block_header_size);
+		if(!TelemetryCompression::read_block_header(data.constData(), data.size(), header))
+			return false;
+		tick = header.first_tick;
+		return true;
+	}
+	default:
+	{
+		QVector< Sample > samples;
+		read_piece(chunk, offset, samples);
+		if(samples.empty())
+			return false;
+		tick = samples.front().st.gyroscope.tick;
+		return true;
+	}
+	}
+}
+
+bool ReplaySource::chunk_first_tick(int chunk, qint64 &tick)
+{
+	Chunk& c = m_chunks[chunk];
+	if(!c.has_first_tick)
+		c.has_first_tick = probe(chunk, align(chunk, c.header_size, c.header_size), c.first_tick);
+	tick = c.first_tick;
+	return c.has_first_tick;
+}
+
+qint64 ReplaySource::read_piece(int chunk, qint64 offset, QVector<Sample> &out)
+{
+	const Chunk& c = m_chunks[chunk];
+	Sample sample;
+
+	switch (m_format) {
+	case TelemetryFormat::Binary:
+	{
+		const int rs = m_schema.record_size;
+		qint64 count = qMin< qint64 >(binary_piece_records, (c.size - offset) / rs);
+		QByteArray data = count > 0? read_at(chunk, offset, count * rs) : QByteArray();
+		count = data.size() / rs;
+		if(!count)
+			return c.size;
+
+		const uchar* rec = (const uchar*)data.constData();
+		for(int i = 0; i < count; i++, rec += rs){
+			TelemetryFormat::decode(rec, m_schema, sample.st);
+			sample.position = c.base + offset + (qint64)i * rs;
+			out.push_back(sample);
+		}
+		return offset + count * rs;
+	}
+	case TelemetryFormat::Compressed:
+	{
+		TelemetryBlockHeader header;
+		QByteArray data = read_at(chunk, offset, TelemetryCompression::block_header_size);
+		if(!TelemetryCompression::read_block_header(data.constData(), data.size(), header))
+			return c.size;
+		QByteArray payload = read_at(chunk, offset + TelemetryCompression::block_header_size, header.size);
+		QByteArray records;
+		if(payload.size() != (int)header.size
+				|| !TelemetryCompression::decode_block(payload.constData(), header, m_schema, m_codec, records)){
+			return c.size;
+		}
+
+		const uchar* rec = (const uchar*)records.constData();
+		for(quint32 i = 0; i < header.count; i++, rec += m_schema.record_size){
+			TelemetryFormat::decode(rec, m_schema, sample.st);
+			sample.position = c.base + offset;
+			out.push_back(sample);
+		}
+		return offset + TelemetryCompression::block_header_size + header.size;
+	}
+	default:
+	{
+		QByteArray data = read_at(chunk, offset, csv_piece_size);
+		if(data.isEmpty())
+			return c.size;
+
+		/// only whole lines, the rest is read with the next piece
+		int end = data.size();
+		if(offset + data.size() < c.size){
+			int nl = data.lastIndexOf('\n');
+			if(nl >= 0)
+				end = nl + 1;
+		}
+
+		const char* begin = data.constData();
+		const char* p = begin;
+		const char* last = begin + end;
+		while(p < last){
+			const char* nl = (const char*)memchr(p, '\n', last - p);
+			const char* line_end = nl? nl : last;
+			if(TelemetryLoader::parse_csv_line(p, line_end, sample.st)){
+				sample.position = c.base + offset + (p - begin);
+				out.push_back(sample);
+			}
+			p = line_end + 1;
+		}
+		return offset + end;
+	}
+	}
+}
+
+void ReplaySource::add_point(Chunk &chunk, qint64 tick, qint64 offset)
+{
+	LogIndexPoint point(tick, offset);
+	QVector< LogIndexPoint >::iterator it = std::lower_bound(chunk.points.begin(), chunk.points.end(), point, point_less);
+
+	/// points are sparse
+	if(it != chunk.points.end() && it->offset - offset < point_interval)
+		return;
+	if(it != chunk.points.begin() && offset - (it - 1)->offset < point_interval)
+		return;
+	chunk.points.insert(it, point);
+}
+
+void ReplaySource::resolve_percent(double percent, int &chunk, qint64 &offset)
+{
+	qint64 global = m_size * percent / 100.;
+
+	chunk = 0;
+	if(m_chunks.empty())
+		return;
+	while(chunk < m_chunks.size() - 1 && global >= m_chunks[chunk].base + m_chunks[chunk].size)
+		chunk++;
+
+	const Chunk& c = m_chunks[chunk];
+	qint64 target = global - c.base;
+
+	/// the nearest point before the target
+	qint64 from = c.header_size;
+	QVector< LogIndexPoint >::const_iterator it = std::upper_bound(c.points.begin(), c.points.end(),
+																	 LogIndexPoint(0, target), point_less);
+	if(it != c.points.begin())
+		from = (it - 1)->offset;
+
+	offset = align(chunk, target, from);
+}
+
+void ReplaySource::resolve_tick(qint64 tick, int &chunk, qint64 &offset)
+{
+	chunk = 0;
+	if(m_chunks.empty())
+		return;
+
+	/// the last chunk started before the tick
+	for(int i = 1; i < m_chunks.size(); i++){
+		qint64 first;
+		if(!chunk_first_tick(i, first))
+			continue;
+		if(first > tick)
+			break;
+		chunk = i;
+	}
+
+	const Chunk& c = m_chunks[chunk];
+	qint64 lo = c.header_size, hi = c.size;
+	foreach (const LogIndexPoint& point, c.points) {
+		if(point.tick <= tick){
+			lo = qMax(lo, point.offset);
+		}else{
+			hi = point.offset;
+			break;
+		}
+	}
+
+	while(hi - lo > bisect_size){
+		qint64 mid = lo + (hi - lo) / 2;
+		qint64 pos = align(chunk, mid, lo);
+		qint64 t;
+		if(pos >= hi){
+			hi = mid;
+			continue;
+		}
+		if(!probe(chunk, pos, t))
+			break;
+		if(t <= tick)
+			lo = pos;
+		else
+			hi = mid;
+	}
+	offset = lo;
+}
@@ -0,0 +1,158 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QVector>
+
+#include <deque>
+
+#include <struct_controls.h>
+
+#include "telemetryformat.h"
+#include "logindex.h"
+
+/**
+ * @brief The ReplaySource class
+ * streaming source of samples for the replay.
+ * the background thread reads ahead from the log to the bounded window,
+ * so the used memory does not depend on the length of the log.
+ * the log is the csv, binary or compressed file or the index of the session (*.idx),
+ * then chunks of the session are read one after another.
+ * seek by percent or by tick uses the sparse index: points from the index of the session
+ * and points collected while reading, between them the position is found by bisection
+ */
+class ReplaySource : public QThread
+{
+public:
+	enum{
+		default_window = 65536
+	};
+
+	explicit ReplaySource(QObject* parent = 0);
+	~ReplaySource();
+
+	/**
+	 * @brief open
+	 * open the log and start reading from the beginning
+	 * @param fileName - log or index of the session
+	 * @return
+	 */
+	bool open(const QString& fileName);
+	void close();
+	bool is_open() const;
+	TelemetryFormat::Format format() const;
+	QString error() const;
+	/**
+	 * @brief size
+	 * @return size of all files of the log
+	 */
+	qint64 size() const;
+
+	/**
+	 * @brief next
+	 * take the next sample from the window. never blocks
+	 * @param st
+	 * @return false if the window is empty: data is not read yet or the end of the log
+	 */
+	bool next(sc::StructTelemetry& st);
+	/**
+	 * @brief at_end
+	 * @return true if all samples are taken
+	 */
+	bool at_end() const;
+	/**
+	 * @brief buffered
+	 * @return count of read samples in the window
+	 */
+	int buffered() const;
+	void set_window(int samples);
+	int window() const;
+
+	void seek_percent(double percent);
+	void seek_tick(qint64 tick);
+	/**
+	 * @brief percent_position
+	 * @return position of the last taken sample in the log [0, 100]
+	 */
+	double percent_position() const;
+
+protected:
+	virtual void run();
+
+private:
+	Q_DISABLE_COPY(ReplaySource)
+
+	struct Chunk{
+		Chunk(): base(0), size(0), header_size(0), first_tick(0), has_first_tick(false) {}
+
+		QString path;
+		/// offset of the chunk in the whole log
+		qint64 base;
+		qint64 size;
+		int header_size;
+		qint64 first_tick;
+		bool has_first_tick;
+		/// sorted by offset
+		QVector< LogIndexPoint > points;
+	};
+	struct Sample{
+		sc::StructTelemetry st;
+		/// offset in the whole log
+		qint64 position;
+	};
+	enum SeekType{
+		SeekPercent,
+		SeekTick
+	};
+
+	QVector< Chunk > m_chunks;
+	TelemetryFormat::Format m_format;
+	TelemetrySchema m_schema;
+	int m_codec;
+	qint64 m_size;
+	QString m_error;
+
+	mutable QMutex m_mutex;
+	QWaitCondition m_cond;
+	std::deque< Sample > m_window;
+	int m_window_size;
+	bool m_eof;
+	bool m_stop;
+	/// changed by each seek, read data of the old generation is dropped
+	int m_generation;
+	SeekType m_seek_type;
+	double m_seek_percent;
+	qint64 m_seek_tick;
+	qint64 m_position;
+
+	/// next members are used by the reading thread only
+	QFile m_file;
+	int m_file_chunk;
+
+	QByteArray read_at(int chunk, qint64 offset, qint64 len);
+	/**
+	 * @brief align
+	 * the first sample at or after the offset
+	 * @param chunk
+	 * @param offset
+	 * @param from - known start of the sample before the offset
+	 * @return
+	 */
+	qint64 align(int chunk, qint64 offset, qint64 from);
+	bool probe(int chunk, qint64 offset, qint64& tick);
+	bool chunk_first_tick(int chunk, qint64& tick);
+	/**
+	 * @brief read_piece
+	 * read samples from the offset
+	 * @return offset after read samples
+	 */
+	qint64 read_piece(int chunk, qint64 offset, QVector< Sample >& out);
+	void add_point(Chunk& chunk, qint64 tick, qint64 offset);
+	void resolve_percent(double percent, int& chunk, qint64& offset);
+	void resolve_tick(qint64 tick, int& chunk, qint64& offset);
+};
+
+#endif // REPLAYSOURCE_H
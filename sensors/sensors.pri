@@ -1,11 +1,33 @@
 INCLUDEPATH += $$PWD
 
-SOURCES += $$PWD/calibrateaccelerometer.cpp \
+SOURCES += $$PWD/asynclogloader.cpp \
+			$$PWD/calibrateaccelerometer.cpp \
+			$$PWD/calibrationjob.cpp \
+			$$PWD/gyrobiastracker.cpp \
 			$$PWD/gyrodata.cpp \
 			$$PWD/gyrodatawidget.cpp \
-			$$PWD/sensorswork.cpp
-HEADERS += $$PWD/calibrateaccelerometer.h \
+			$$PWD/loganalyzer.cpp \
+			$$PWD/pointcloudlod.cpp \
+			$$PWD/replaycheckpoints.cpp \
+			$$PWD/replayengine.cpp \
+			$$PWD/replaysource.cpp \
+			$$PWD/sensorswork.cpp \
+			$$PWD/spheregriddecimator.cpp \
+			$$PWD/telemetrycolumns.cpp \
+			$$PWD/telemetryloader.cpp
+HEADERS += $$PWD/asynclogloader.h \
+			$$PWD/calibrateaccelerometer.h \
+			$$PWD/calibrationjob.h \
+			$$PWD/gyrobiastracker.h \
 			$$PWD/gyrodata.h \
 			$$PWD/gyrodatawidget.h \
-			$$PWD/sensorswork.h
+			$$PWD/loganalyzer.h \
+			$$PWD/pointcloudlod.h \
+			$$PWD/replaycheckpoints.h \
+			$$PWD/replayengine.h \
+			$$PWD/replaysource.h \
+			$$PWD/sensorswork.h \
+			$$PWD/spheregriddecimator.h \
+			$$PWD/telemetrycolumns.h \
+			$$PWD/telemetryloader.h
 FORMS += $$PWD/gyrodatawidget.ui
@@ -134,9 +134,22 @@ matrix::Matrix3d fromQuaternionM3(const Quaternion &q_in)
 
 /////////////////////////////////////////////////////
 
-SensorsWork::SensorsWork(QObject *parent)
+SensorsWork::State::State()
+	: len_Gaccel(0)
+	, part_of_time(0)
+	, past_tick(0)
+	, first_tick(0)
+	, is_calculated(false)
+	, is_start_correction(false)
+{
+}
+
+/////////////////////////////////////////////////////
+
+SensorsWork::SensorsWork(QObject *parent, bool load_config)
 	: QThread(parent)
 	, m_socket(0)
+	, m_timer(0)
 	, m_is_calc_offset_gyro(false)
 	, m_count_gyro_offset_data(0)
 	, m_is_calculated(false)
@@ -153,6 +166,8 @@ SensorsWork::SensorsWork(QObject *parent)
 	, m_curcalc_pos(POS_0)
 	, m_is_start_correction(false)
 	, m_receiver_port(7770)
+	, m_auto_gyro_bias(true)
+	, m_auto_level(false)
 	, m_typeOfCalibrate(NONE)
 	, m_max_threshold_angle(3)
 	, m_min_threshold_angle(1e-1)
@@ -162,14 +177,17 @@ SensorsWork::SensorsWork(QObject *parent)
 {
 	connect(this, SIGNAL(bind_address()), this, SLOT(_on_bind_address()), Qt::QueuedConnection);
 	connect(this, SIGNAL(send_to_socket(QByteArray)), this, SLOT(_on_send_to_socket(QByteArray)), Qt::QueuedConnection);
-	connect(this, SIGNAL(start_calibration_watcher()), this, SLOT(_on_start_calibration_watcher()), Qt::QueuedConnection);
+	connect(this, SIGNAL(calibration_finished(int)), this, SLOT(_on_calibration_finished(int)), Qt::QueuedConnection);
 
-	load_calibrate();
+	if(load_config)
+		load_calibrate();
 }
 
 SensorsWork::~SensorsWork()
 {
-	QThreadPool::globalInstance()->waitForDone();
+	/// jobs check the cancel flag inside the grid search, so the wait is short
+	cancel_calibrations();
+	m_calibration_pool.waitForDone();
 
 	quit();
 	wait();
@@ -177,9 +195,6 @@ SensorsWork::~SensorsWork()
 	if(m_timer){
 		delete m_timer;
 	}
-	if(m_timer_calibrate){
-		delete m_timer_calibrate;
-	}
 }
 
 int SensorsWork::count_gyro_offset_data() const
@@ -227,45 +242,77 @@ void SensorsWork::set_address(const QHostAddress &address, ushort port)
 
 bool SensorsWork::calibrate_accelerometer(const QVector<Vector3d> &data)
 {
-	if(m_calibrate.is_progress() || !data.size())
-		return false;
-
-	m_calibrate.set_parameters(data);
-
-	m_typeOfCalibrate = Accelerometer;
-
-	emit start_calibration_watcher();
+	return !start_calibration(Accelerometer, data).isNull();
+}
 
-	QThreadPool::globalInstance()->start(new CalibrateAccelerometerRunnable(&m_calibrate));
+bool SensorsWork::calibrate_compass(const QVector<Vector3d> &data)
+{
+	return !start_calibration(Compass, data).isNull();
+}
 
-	return true;
+bool SensorsWork::calibrate_gyro_bias(const QVector<Vector3d> &data)
+{
+	return !start_calibration(GyroBias, data).isNull();
 }
 
-bool SensorsWork::calibrate_compass(const QVector<Vector3d> &data)
+CalibrationJobPtr SensorsWork::start_calibration(SensorsWork::TypeOfCalibrate type, const QVector<Vector3d> &data)
 {
-	if(m_calibrate.is_progress() || !data.size())
-		return false;
+	if(type == NONE || !data.size() || is_calibrating(type))
+		return CalibrationJobPtr();
 
-	m_calibrate.set_parameters(data);
+	CalibrationJobPtr job;
+	if(type == GyroBias){
+		job = CalibrationJobPtr(new GyroBiasJob(type, data));
+	}else{
+		SphereCalibrationJob* sjob = new SphereCalibrationJob(type, data);
+		connect(sjob->calibrate(), SIGNAL(send_log(QString)), this, SIGNAL(add_to_log(QString)));
+		job = CalibrationJobPtr(sjob);
+	}
 
-	m_typeOfCalibrate = Compass;
+	job->set_callback([this](CalibrationJob* job){
+		emit calibration_finished(job->type());
+	});
 
-	emit start_calibration_watcher();
+	{
+		QMutexLocker lock(&m_mutex_jobs);
+		m_calibration_jobs[type] = job;
+	}
 
-	QThreadPool::globalInstance()->start(new CalibrateAccelerometerRunnable(&m_calibrate));
+	m_calibration_pool.start(new CalibrationJobRunnable(job));
 
-	return true;
+	return job;
+}
 
+CalibrationJobPtr SensorsWork::calibration_job(SensorsWork::TypeOfCalibrate type) const
+{
+	QMutexLocker lock(&m_mutex_jobs);
+	return m_calibration_jobs.value(type);
 }
 
-void SensorsWork::reset_calibration_compass()
+bool SensorsWork::is_calibrating(SensorsWork::TypeOfCalibrate type) const
 {
-	m_sphere_compass.reset();
+	CalibrationJobPtr job = calibration_job(type);
+	return !job.isNull() && !job->is_done();
 }
 
-const CalibrateAccelerometer &SensorsWork::calibrate_thread() const
+void SensorsWork::cancel_calibration(SensorsWork::TypeOfCalibrate type)
 {
-	return m_calibrate;
+	CalibrationJobPtr job = calibration_job(type);
+	if(!job.isNull())
+		job->cancel();
+}
+
+void SensorsWork::cancel_calibrations()
+{
+	QMutexLocker lock(&m_mutex_jobs);
+	foreach (CalibrationJobPtr job, m_calibration_jobs) {
+		job->cancel();
+	}
+}
+
+void SensorsWork::reset_calibration_compass()
+{
+	m_sphere_compass.reset();
 }
 
 SensorsWork::TypeOfCalibrate SensorsWork::typeOfCalibrate() const
@@ -276,14 +323,10 @@ SensorsWork::TypeOfCalibrate SensorsWork::typeOfCalibrate() const
 void SensorsWork::run()
 {
 	m_timer = new QTimer;
-	m_timer_calibrate = new QTimer;
 
 	connect(m_timer, SIGNAL(timeout()), this, SLOT(_on_timeout()));
 	m_timer->start(300);
 
-	connect(m_timer_calibrate, SIGNAL(timeout()), this, SLOT(_on_timeout_calibrate()));
-	m_timer_calibrate->setInterval(300);
-
 	m_time_waiting_telemetry.start();
 
 	m_socket = new QUdpSocket;
@@ -305,6 +348,7 @@ void SensorsWork::reset_mean_sphere()
 
 void SensorsWork::_on_timeout()
 {
+	QMutexLocker lock(&m_mutex_pipeline);
 	if(telemetries.size() > 3){
 		telemetries.pop_back();
 	}
@@ -320,11 +364,6 @@ void SensorsWork::_on_send_to_socket(const QByteArray &data)
 	m_socket->writeDatagram(data, m_addr, m_port);
 }
 
-void SensorsWork::_on_start_calibration_watcher()
-{
-	m_timer_calibrate->start();
-}
-
 bool SensorsWork::is_exists_value(SensorsWork::POS pos) const
 {
 	return !m_pos_values[pos].isNull();
@@ -367,6 +406,8 @@ void SensorsWork::start_calc_offset_gyro()
 
 void SensorsWork::stop_calc_offset_gyro()
 {
+	QMutexLocker lock(&m_mutex_pipeline);
+
 	m_is_calc_offset_gyro = false;
 	if(m_count_gyro_offset_data){
 		m_offset_gyro *= 1.0/m_count_gyro_offset_data;
@@ -380,6 +421,8 @@ void SensorsWork::stop_calc_offset_gyro()
 		rotate_quaternion = Quaternion();
 		m_translate_pos = Vector3d();
 		m_is_calculated = true;
+		/// the tracking continues from the calculated offset
+		m_bias_tracker.seed(m_offset_gyro);
 
 		Vector3d v = meanGaccel;
 		emit add_to_log("offset values.  gyroscope: " + QString::number(m_offset_gyro.x(), 'f', 3) + ", " +
@@ -392,6 +435,79 @@ void SensorsWork::stop_calc_offset_gyro()
 	}
 }
 
+void SensorsWork::set_auto_gyro_bias(bool value)
+{
+	QMutexLocker lock(&m_mutex_pipeline);
+
+	m_auto_gyro_bias = value;
+	m_bias_tracker.reset();
+	if(!m_offset_gyro.isNull())
+		m_bias_tracker.seed(m_offset_gyro);
+}
+
+void SensorsWork::set_auto_level(bool value)
+{
+	m_auto_level = value;
+}
+
+SensorsWork::State SensorsWork::state() const
+{
+	QMutexLocker lock(&m_mutex_pipeline);
+
+	State res;
+	for(int i = 0; i < 3; i++){
+		res.kalman[i] = m_kalman[i];
+	}
+	res.bias_tracker = m_bias_tracker;
+	res.rotate_quaternion = rotate_quaternion;
+	res.accel_quat = accel_quat;
+	res.mean_accel = mean_accel;
+	res.tmp_accel = tmp_accel;
+	res.meanGaccel = meanGaccel;
+	res.offset_gyro = m_offset_gyro;
+	res.prev_accel = m_prev_accel;
+	res.len_Gaccel = m_len_Gaccel;
+	res.part_of_time = m_part_of_time;
+	res.past_tick = m_past_tick;
+	res.first_tick = m_first_tick;
+	res.is_calculated = m_is_calculated;
+	res.is_start_correction = m_is_start_correction;
+	return res;
+}
+
+void SensorsWork::set_state(const State &state)
+{
+	QMutexLocker lock(&m_mutex_pipeline);
+
+	for(int i = 0; i < 3; i++){
+		m_kalman[i] = state.kalman[i];
+	}
+	m_bias_tracker = state.bias_tracker;
+	rotate_quaternion = state.rotate_quaternion;
+	accel_quat = state.accel_quat;
+	mean_accel = state.mean_accel;
+	tmp_accel = state.tmp_accel;
+	meanGaccel = state.meanGaccel;
+	m_offset_gyro = state.offset_gyro;
+	m_prev_accel = state.prev_accel;
+	m_len_Gaccel = state.len_Gaccel;
+	m_part_of_time = state.part_of_time;
+	m_past_tick = state.past_tick;
+	m_first_tick = state.first_tick;
+	m_is_calculated = state.is_calculated;
+	m_is_start_correction = state.is_start_correction;
+
+	telemetries.clear();
+}
+
+void SensorsWork::restart_pipeline()
+{
+	QMutexLocker lock(&m_mutex_pipeline);
+
+	set_position();
+	telemetries.clear();
+}
+
 void SensorsWork::calc_correction()
 {
 	if(meanGaccel.isNull())
@@ -427,10 +543,15 @@ void SensorsWork::load_calibrate()
 {
 	QString config_file = /*QDir::homePath() + */QApplication::applicationDirPath() + "/" + config_dir + xml_calibrate;
 
+	load_calibrate(config_file);
+}
+
+bool SensorsWork::load_calibrate(const QString &config_file)
+{
 	SimpleXML sxml(config_file, SimpleXML::READ);
 
 	if(!sxml.isLoaded())
-		return;
+		return false;
 
 	Vector3d v;
 	SimpleXMLNode node = sxml["acceleration"];
@@ -477,6 +598,23 @@ void SensorsWork::load_calibrate()
 		m_is_calc_offset_gyro = false;
 	}
 
+	QMutexLocker lock(&m_mutex_pipeline);
+
+	node = sxml["gyroscope"];
+	if(!node["auto_bias"].empty())
+		m_auto_gyro_bias = node["auto_bias"];
+	if(!node["stationary_window"].empty())
+		m_bias_tracker.set_window(node["stationary_window"]);
+	if(!node["stationary_gyro_variance"].empty() && !node["stationary_accel_variance"].empty())
+		m_bias_tracker.set_thresholds(node["stationary_gyro_variance"], node["stationary_accel_variance"]);
+	if(!node["bias_temperature_bin"].empty())
+		m_bias_tracker.set_temperature_bin(node["bias_temperature_bin"]);
+	if(!node["auto_level"].empty())
+		m_auto_level = node["auto_level"];
+	/// the saved offset is not replaced by the tracker until it measures the drift
+	if(!m_offset_gyro.isNull())
+		m_bias_tracker.seed(m_offset_gyro);
+
 	if(!sxml["compass"].empty()){
 		node = sxml["compass"];
 		m_sphere_compass.cp.setX((double)node["x_corr"]);
@@ -487,6 +625,7 @@ void SensorsWork::load_calibrate()
 	}
 
 	calc_correction();
+	return true;
 }
 
 void SensorsWork::save_calibrate()
@@ -515,12 +654,18 @@ void SensorsWork::save_calibrate()
 	node << "multiply_correction" << m_multiply_correction;
 	node << "coeff_deltaAngle" << m_coeff_deltaAngle;
 
+	node = sxml["gyroscope"];
 	if(!m_offset_gyro.isNull()){
-		node = sxml["gyroscope"];
 		node << "x_corr" << m_offset_gyro.x() <<
 		"y_corr" << m_offset_gyro.y() <<
 		"z_corr" << m_offset_gyro.z();
 	}
+	node << "auto_bias" << m_auto_gyro_bias;
+	node << "stationary_window" << m_bias_tracker.window();
+	node << "stationary_gyro_variance" << m_bias_tracker.threshold_gyro();
+	node << "stationary_accel_variance" << m_bias_tracker.threshold_accel();
+	node << "bias_temperature_bin" << m_bias_tracker.temperature_bin();
+	node << "auto_level" << m_auto_level;
 
 	if(!meanGaccel.isNull()){
 		node = sxml["mean_g_accel"];
@@ -537,36 +682,55 @@ void SensorsWork::save_calibrate()
 	}
 }
 
-void SensorsWork::_on_timeout_calibrate()
+void SensorsWork::_on_calibration_finished(int type)
 {
-	if(m_calibrate.is_done()){
+	CalibrationJobPtr job = calibration_job((TypeOfCalibrate)type);
 
-		switch (m_typeOfCalibrate) {
-			case Accelerometer:
-				m_sphere = m_calibrate.result();
-				emit add_to_log("evaluate accelerometer. x=" + QString::number(m_sphere.cp.x(), 'f', 3) +
-						   ", y=" + QString::number(m_sphere.cp.y(), 'f', 3) +
-						   ", z=" + QString::number(m_sphere.cp.z(), 'f', 3) +
-						   "; R=" + QString::number(m_sphere.mean_radius, 'f', 3) +
-						   "; dev=" + QString::number(m_sphere.deviation, 'f', 3));
-
-				break;
-			case Compass:
-				m_sphere_compass = m_calibrate.result();
-				emit add_to_log("evaluate compass. x=" + QString::number(m_sphere_compass.cp.x(), 'f', 3) +
-						   ", y=" + QString::number(m_sphere_compass.cp.y(), 'f', 3) +
-						   ", z=" + QString::number(m_sphere_compass.cp.z(), 'f', 3) +
-						   "; R=" + QString::number(m_sphere_compass.mean_radius, 'f', 3) +
-						   "; dev=" + QString::number(m_sphere_compass.deviation, 'f', 3));
-			default:
-				break;
-		}
+	if(job.isNull() || job->is_cancelled() || !job->is_done())
+		return;
 
-		save_calibrate();
-		m_timer_calibrate->stop();
+	StructMeanSphere res = job->result();
+	if(res.empty())
+		return;
 
-		emit stop_calibration();
+	m_typeOfCalibrate = (TypeOfCalibrate)type;
+
+	switch (m_typeOfCalibrate) {
+		case Accelerometer:
+			m_sphere = res;
+			emit add_to_log("evaluate accelerometer. x=" + QString::number(m_sphere.cp.x(), 'f', 3) +
+					   ", y=" + QString::number(m_sphere.cp.y(), 'f', 3) +
+					   ", z=" + QString::number(m_sphere.cp.z(), 'f', 3) +
+					   "; R=" + QString::number(m_sphere.mean_radius, 'f', 3) +
+					   "; dev=" + QString::number(m_sphere.deviation, 'f', 3));
+
+			break;
+		case Compass:
+			m_sphere_compass = res;
+			emit add_to_log("evaluate compass. x=" + QString::number(m_sphere_compass.cp.x(), 'f', 3) +
+					   ", y=" + QString::number(m_sphere_compass.cp.y(), 'f', 3) +
+					   ", z=" + QString::number(m_sphere_compass.cp.z(), 'f', 3) +
+					   "; R=" + QString::number(m_sphere_compass.mean_radius, 'f', 3) +
+					   "; dev=" + QString::number(m_sphere_compass.deviation, 'f', 3));
+			break;
+		case GyroBias:
+			{
+				QMutexLocker lock(&m_mutex_pipeline);
+				m_offset_gyro = res.cp;
+				m_bias_tracker.seed(m_offset_gyro);
+			}
+			emit add_to_log("evaluate gyroscope bias. x=" + QString::number(res.cp.x(), 'f', 3) +
+					   ", y=" + QString::number(res.cp.y(), 'f', 3) +
+					   ", z=" + QString::number(res.cp.z(), 'f', 3) +
+					   "; dev=" + QString::number(res.deviation, 'f', 3));
+			break;
+		default:
+			break;
 	}
+
+	save_calibrate();
+
+	emit stop_calibration();
 }
 
 void remove_lowbits(Vector3i& v, int bits)
@@ -607,10 +771,6 @@ void SensorsWork::tryParseData(const QByteArray &data)
 	m_time_waiting_telemetry.restart();
 
 	m_index++;
-
-	while(telemetries.size() >= max_count_telemetry){
-		telemetries.pop_back();
-	}
 }
 
 const int min_threshold_accel = 200;
@@ -632,6 +792,8 @@ static inline Quaternion fromAnglesAxes(const Vector3d& angles)
 
 StructTelemetry SensorsWork::analyze_telemetry(const StructTelemetry &st_in)
 {
+	QMutexLocker lock(&m_mutex_pipeline);
+
 	StructTelemetry st(st_in);
 
 	if(st.gyroscope.tick && m_first_tick){
@@ -648,6 +810,8 @@ StructTelemetry SensorsWork::analyze_telemetry(const StructTelemetry &st_in)
 
 	emit fill_data_for_calibration(st);
 
+	track_gyro_bias(st);
+
 	/// a subtraction of the offset error of acceleration of the sensor
 	st.gyroscope.accel -= m_sphere.cp;
 
@@ -788,6 +952,39 @@ void SensorsWork::calc_offsets(const Vector3i &gyro, const Vector3i &accel)
 	}
 }
 
+void SensorsWork::track_gyro_bias(const StructTelemetry &st)
+{
+	if(!m_auto_gyro_bias || m_is_calc_offset_gyro)
+		return;
+
+	bool stationary = m_bias_tracker.is_stationary();
+
+	m_bias_tracker.add(st.gyroscope.gyro, st.gyroscope.accel, st.gyroscope.temp);
+
+	if(stationary != m_bias_tracker.is_stationary()){
+		emit set_text("stationary", m_bias_tracker.is_stationary()? "yes" : "no");
+	}
+
+	if(!m_bias_tracker.has_bias())
+		return;
+
+	m_offset_gyro = m_bias_tracker.bias(st.gyroscope.temp);
+
+	/// the first still interval replaces the manual calculation of offsets
+	if(m_auto_level && !m_is_calculated && m_bias_tracker.is_stationary()){
+		meanGaccel = m_bias_tracker.mean_accel() - m_sphere.cp;
+		m_len_Gaccel = meanGaccel.length();
+		tmp_accel = meanGaccel;
+		rotate_quaternion = Quaternion();
+		m_is_calculated = true;
+
+		emit add_to_log("device is still. gyroscope bias: " + QString::number(m_offset_gyro.x(), 'f', 3) + ", " +
+						QString::number(m_offset_gyro.y(), 'f', 3) + ", " +
+						QString::number(m_offset_gyro.z(), 'f', 3));
+		calc_correction();
+	}
+}
+
 void SensorsWork::simple_kalman_filter(const StructTelemetry &st, StructTelemetry &st_out)
 {
 	emit get_data("gyro", st.gyroscope.gyro);
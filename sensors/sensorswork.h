@@ -13,10 +13,13 @@
 #include "struct_controls.h"
 
 #include <QElapsedTimer>
+#include <QThreadPool>
 
 #include "spheregl.h"
 #include "simplekalmanfilter.h"
 #include "calibrateaccelerometer.h"
+#include "calibrationjob.h"
+#include "gyrobiastracker.h"
 
 class QUdpSocket;
 
@@ -31,10 +34,42 @@ public:
 	enum TypeOfCalibrate{
 		NONE,
 		Accelerometer,
-		Compass
+		Compass,
+		GyroBias
 	};
 
-	SensorsWork(QObject* parent = 0);
+	/**
+	 * @brief The State struct
+	 * state of the pipeline changed by analyze_telemetry.
+	 * the trail of telemetries is not included, it is refilled by next samples
+	 */
+	struct State{
+		State();
+
+		/// filters used by simple_kalman_filter
+		SimpleKalmanFilter kalman[3];
+		GyroBiasTracker bias_tracker;
+		quaternions::Quaternion rotate_quaternion;
+		quaternions::Quaternion accel_quat;
+		vector3_::Vector3d mean_accel;
+		vector3_::Vector3d tmp_accel;
+		vector3_::Vector3d meanGaccel;
+		vector3_::Vector3d offset_gyro;
+		vector3_::Vector3d prev_accel;
+		double len_Gaccel;
+		double part_of_time;
+		long long past_tick;
+		long long first_tick;
+		bool is_calculated;
+		bool is_start_correction;
+	};
+
+	/**
+	 * @brief SensorsWork
+	 * @param parent
+	 * @param load_config - load calibrate.xml of the application, otherwise the calibration is default
+	 */
+	SensorsWork(QObject* parent = 0, bool load_config = true);
 	~SensorsWork();
 
 	QHostAddress addr() const;
@@ -62,16 +97,46 @@ public:
 	 */
 	bool calibrate_accelerometer(const QVector< vector3_::Vector3d > &data);
 	bool calibrate_compass(const QVector< vector3_::Vector3d > &data);
+	bool calibrate_gyro_bias(const QVector< vector3_::Vector3d > &data);
+	/**
+	 * @brief start_calibration
+	 * start the job in the pool. jobs of different types run concurrently
+	 * @param type
+	 * @param data
+	 * @return handle of the job or null if job of this type is in progress
+	 */
+	CalibrationJobPtr start_calibration(TypeOfCalibrate type, const QVector< vector3_::Vector3d > &data);
+	/**
+	 * @brief calibration_job
+	 * last started job of the type
+	 * @param type
+	 * @return
+	 */
+	CalibrationJobPtr calibration_job(TypeOfCalibrate type) const;
+	bool is_calibrating(TypeOfCalibrate type) const;
+	void cancel_calibration(TypeOfCalibrate type);
+	void cancel_calibrations();
 
 	void reset_calibration_compass();
 	void reset_mean_sphere();
 
-	const CalibrateAccelerometer &calibrate_thread() const;
+	/**
+	 * @brief typeOfCalibrate
+	 * type of the last finished calibration
+	 * @return
+	 */
 	TypeOfCalibrate typeOfCalibrate() const;
 
 	/// \brief save & load calibrated data
 	void save_calibrate();
 	void load_calibrate();
+	/**
+	 * @brief load_calibrate
+	 * load the calibration from the file
+	 * @param config_file
+	 * @return false if the file is not loaded
+	 */
+	bool load_calibrate(const QString& config_file);
 
 	enum POS{
 		POS_0 = 0,
@@ -89,6 +154,39 @@ public:
 	void start_calc_offset_gyro();
 	void stop_calc_offset_gyro();
 	void calc_correction();
+	/**
+	 * @brief set_auto_gyro_bias
+	 * track the gyroscope bias while the device is still
+	 * @param value
+	 */
+	void set_auto_gyro_bias(bool value);
+	bool is_auto_gyro_bias() const { return m_auto_gyro_bias; }
+	/**
+	 * @brief set_auto_level
+	 * take the gravity and the start of the orientation from the first still interval
+	 * when offsets are not calculated. works with the tracking of the gyroscope bias
+	 * @param value
+	 */
+	void set_auto_level(bool value);
+	bool is_auto_level() const { return m_auto_level; }
+	const GyroBiasTracker& gyro_bias_tracker() const { return m_bias_tracker; }
+	/**
+	 * @brief state
+	 * checkpoint of the pipeline. may be called from any thread
+	 * @return
+	 */
+	State state() const;
+	/**
+	 * @brief set_state
+	 * restore the checkpoint, the trail of telemetries is cleared. may be called from any thread
+	 * @param state
+	 */
+	void set_state(const State& state);
+	/**
+	 * @brief restart_pipeline
+	 * reset the position and the trail of telemetries before the play from the start of the log
+	 */
+	void restart_pipeline();
 
 public:
 	/**
@@ -115,7 +213,7 @@ signals:
 	void set_text(const QString& key, const QString text);
 	void stop_calibration();
 	void fill_data_for_calibration(const sc::StructTelemetry& st);
-	void start_calibration_watcher();
+	void calibration_finished(int type);
 
 protected:
 	virtual void run();
@@ -123,11 +221,10 @@ protected:
 
 public slots:
 	void _on_readyRead();
-	void _on_timeout_calibrate();
+	void _on_calibration_finished(int type);
 	void _on_timeout();
 	void _on_bind_address();
 	void _on_send_to_socket(const QByteArray& data);
-	void _on_start_calibration_watcher();
 
 private:
 	QUdpSocket *m_socket;
@@ -144,7 +241,6 @@ private:
 	bool m_is_calculated;
 
 	QTimer *m_timer;
-	QTimer *m_timer_calibrate;
 
 	QTime m_time_waiting_telemetry;
 	QElapsedTimer m_tick_telemetry;
@@ -174,7 +270,15 @@ private:
 
 	StructMeanSphere m_sphere;
 	StructMeanSphere m_sphere_compass;
-	CalibrateAccelerometer m_calibrate;
+	GyroBiasTracker m_bias_tracker;
+	bool m_auto_gyro_bias;
+	bool m_auto_level;
+	QThreadPool m_calibration_pool;
+	QMap< TypeOfCalibrate, CalibrationJobPtr > m_calibration_jobs;
+	mutable QMutex m_mutex_jobs;
+	/// guards the state of the pipeline and the tracker of the bias: analyze_telemetry runs in the thread
+	/// of SensorsWork for the device and in the gui thread for the replay without the socket
+	mutable QMutex m_mutex_pipeline;
 	TypeOfCalibrate m_typeOfCalibrate;
 
 	double m_max_threshold_angle;
@@ -184,6 +288,12 @@ private:
 
 	void calccount(const sc::StructTelemetry& st);
 	void calc_offsets(const vector3_::Vector3i &gyro, const vector3_::Vector3i &accel);
+	/**
+	 * @brief track_gyro_bias
+	 * update the bias by raw data and apply it to m_offset_gyro
+	 * @param st
+	 */
+	void track_gyro_bias(const sc::StructTelemetry& st);
 	void clear_data();
 	/**
 	 * @brief simple_kalman_filter
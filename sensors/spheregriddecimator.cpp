@@ -0,0 +1,135 @@
+#include "spheregriddecimator.h"
+
+#include "calibrateaccelerometer.h"
+
+using namespace vector3_;
+
+SphereGridDecimator::SphereGridDecimator(int count_azimuth, int count_elevation, int max_in_cell)
+	: m_count_azimuth(1)
+	, m_count_elevation(1)
+	, m_max_in_cell(1)
+{
+	set_grid(count_azimuth, count_elevation);
+	set_max_in_cell(max_in_cell);
+}
+
+void SphereGridDecimator::set_grid(int count_azimuth, int count_elevation)
+{
+	m_count_azimuth = qMax(1, count_azimuth);
+	m_count_elevation = qMax(1, count_elevation);
+	m_counts.clear();
+}
+
+void SphereGridDecimator::set_max_in_cell(int value)
+{
+	m_max_in_cell = qMax(1, value);
+}
+
+int SphereGridDecimator::cell_index(const Vector3d &v) const
+{
+	Vector3d d = v - m_center;
+	double len = d.length();
+	if(qFuzzyIsNull(len))
+		return 0;
+
+	/// equal-area cells: uniform by azimuth and by cos(elevation)
+	double az = (atan2(d.y(), d.x()) + M_PI) / (2 * M_PI);
+	double el = (d.z() / len + 1.) / 2.;
+
+	int ia = qBound(0, (int)(az * m_count_azimuth), m_count_azimuth - 1);
+	int ie = qBound(0, (int)(el * m_count_elevation), m_count_elevation - 1);
+
+	return ie * m_count_azimuth + ia;
+}
+
+QVector<Vector3d> SphereGridDecimator::decimate(const QVector<Vector3d> &data)
+{
+	QVector< Vector3d > res;
+
+	m_counts.fill(0, count_cells());
+	m_center = Vector3d();
+
+	if(!data.size())
+		return res;
+
+	Vector3d vmin = data[0], vmax = data[0];
+	for(int i = 1; i < data.size(); i++){
+		vmin = min_v(vmin, data[i]);
+		vmax = max_v(vmax, data[i]);
+	}
+	m_center = (vmin + vmax) * 0.5;
+
+	/// first pass: count samples in each cell
+	QVector< int > cells(data.size());
+	for(int i = 0; i < data.size(); i++){
+		cells[i] = cell_index(data[i]);
+		m_counts[cells[i]]++;
+	}
+
+	/// second pass: take each stride-th sample of the cell so the kept samples are spread over the record
+	QVector< int > seen(m_counts.size(), 0);
+	QVector< int > kept(m_counts.size(), 0);
+
+	int count_res = 0;
+	foreach (int cnt, m_counts) {
+		count_res += qMin(cnt, m_max_in_cell);
+	}
+	res.reserve(count_res);
+
+	for(int i = 0; i < data.size(); i++){
+		int c = cells[i];
+		int stride = (m_counts[c] + m_max_in_cell - 1) / m_max_in_cell;
+		if(seen[c]++ % stride == 0 && kept[c] < m_max_in_cell){
+			kept[c]++;
+			res.push_back(data[i]);
+		}
+	}
+
+	return res;
+}
+
+int SphereGridDecimator::count_in_cell(int azimuth, int elevation) const
+{
+	int id = elevation * m_count_azimuth + azimuth;
+	if(id < 0 || id >= m_counts.size())
+		return 0;
+	return m_counts[id];
+}
+
+int SphereGridDecimator::count_cells() const
+{
+	return m_count_azimuth * m_count_elevation;
+}
+
+int SphereGridDecimator::count_empty_cells() const
+{
+	if(m_counts.isEmpty())
+		return count_cells();
+
+	int res = 0;
+	foreach (int cnt, m_counts) {
+		if(!cnt)
+			res++;
+	}
+	return res;
+}
+
+QStringList SphereGridDecimator::coverage() const
+{
+	QStringList res;
+	for(int ie = m_count_elevation - 1; ie >= 0; ie--){
+		QString line;
+		for(int ia = 0; ia < m_count_azimuth; ia++){
+			int cnt = count_in_cell(ia, ie);
+			if(!cnt){
+				line += '.';
+			}else if(cnt >= m_max_in_cell){
+				line += '#';
+			}else{
+				line += QChar('1' + qMin(8, 9 * cnt / m_max_in_cell));
+			}
+		}
+		res.push_back(line);
+	}
+	return res;
+}
@@ -0,0 +1,78 @@
+#ifndef SPHEREGRIDDECIMATOR_H
+#define SPHEREGRIDDECIMATOR_H
+
+#include <QVector>
+#include <QStringList>
+
+#include "struct_controls.h"
+
+/**
+ * @brief The SphereGridDecimator class
+ * spatial decimation of calibration samples.
+ * vectors are bucketed by their direction from the center of the bounding box
+ * into an equal-area grid (azimuth x cos(elevation)) and each cell keeps a bounded
+ * count of evenly strided samples
+ */
+class SphereGridDecimator
+{
+public:
+	SphereGridDecimator(int count_azimuth = 24, int count_elevation = 12, int max_in_cell = 32);
+
+	/**
+	 * @brief set_grid
+	 * @param count_azimuth - count of cells around Z axis
+	 * @param count_elevation - count of cells from the bottom to the top
+	 */
+	void set_grid(int count_azimuth, int count_elevation);
+	int count_azimuth() const { return m_count_azimuth; }
+	int count_elevation() const { return m_count_elevation; }
+	/**
+	 * @brief set_max_in_cell
+	 * maximum count of samples kept in one cell
+	 * @param value
+	 */
+	void set_max_in_cell(int value);
+	int max_in_cell() const { return m_max_in_cell; }
+
+	/**
+	 * @brief decimate
+	 * @param data - source samples
+	 * @return bounded subset of samples
+	 */
+	QVector< vector3_::Vector3d > decimate(const QVector< vector3_::Vector3d >& data);
+
+	/**
+	 * @brief counts
+	 * count of source samples in each cell after last decimate.
+	 * index = elevation * count_azimuth + azimuth
+	 * @return
+	 */
+	const QVector< int >& counts() const { return m_counts; }
+	int count_in_cell(int azimuth, int elevation) const;
+	int count_cells() const;
+	int count_empty_cells() const;
+	/**
+	 * @brief center
+	 * center of the grid used in last decimate
+	 * @return
+	 */
+	vector3_::Vector3d center() const { return m_center; }
+	/**
+	 * @brief coverage
+	 * one line per elevation row (from the top): '.' - empty cell,
+	 * '1'..'9' - partly filled cell, '#' - cell contain max_in_cell or more samples
+	 * @return
+	 */
+	QStringList coverage() const;
+
+private:
+	int m_count_azimuth;
+	int m_count_elevation;
+	int m_max_in_cell;
+	vector3_::Vector3d m_center;
+	QVector< int > m_counts;
+
+	int cell_index(const vector3_::Vector3d& v) const;
+};
+
+#endif // SPHEREGRIDDECIMATOR_H
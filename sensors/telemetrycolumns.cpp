@@ -0,0 +1,357 @@
+#include "telemetrycolumns.h"
+
+#include <limits>
+
+using namespace sc;
+using namespace vector3_;
+
+PackedColumn::PackedColumn()
+	: m_wide(false)
+{
+
+}
+
+void PackedColumn::push_back(qint32 value)
+{
+	if(!m_wide && (value < std::numeric_limits< qint16 >::min() || value > std::numeric_limits< qint16 >::max())){
+		promote();
+	}
+	if(m_wide)
+		m_data32.push_back(value);
+	else
+		m_data16.push_back(static_cast< qint16 >(value));
+}
+
+void PackedColumn::append(const PackedColumn &other)
+{
+	if(other.m_wide && !m_wide)
+		promote();
+	if(!m_wide){
+		m_data16 += other.m_data16;
+	}else if(other.m_wide){
+		m_data32 += other.m_data32;
+	}else{
+		m_data32.reserve(m_data32.size() + other.m_data16.size());
+		foreach (qint16 value, other.m_data16) {
+			m_data32.push_back(value);
+		}
+	}
+}
+
+int PackedColumn::size() const
+{
+	return m_wide? m_data32.size() : m_data16.size();
+}
+
+void PackedColumn::reserve(int count)
+{
+	if(m_wide)
+		m_data32.reserve(count);
+	else
+		m_data16.reserve(count);
+}
+
+void PackedColumn::clear()
+{
+	m_data16.clear();
+	m_data32.clear();
+	m_wide = false;
+}
+
+bool PackedColumn::is_wide() const
+{
+	return m_wide;
+}
+
+size_t PackedColumn::bytes() const
+{
+	return m_data16.capacity() * sizeof(qint16) + m_data32.capacity() * sizeof(qint32);
+}
+
+void PackedColumn::promote()
+{
+	m_data32.reserve(qMax(m_data16.capacity(), m_data16.size() + 1));
+	for(int i = 0; i < m_data16.size(); ++i){
+		m_data32.push_back(m_data16[i]);
+	}
+	m_data16 = QVector< qint16 >();
+	m_wide = true;
+}
+
+///////////////////////////////////
+
+TickColumn::TickColumn()
+	: m_base(0)
+	, m_far(false)
+{
+
+}
+
+void TickColumn::push_back(qint64 value)
+{
+	if(m_far){
+		m_ticks.push_back(value);
+		return;
+	}
+	if(!m_offsets.size())
+		m_base = value;
+
+	qint64 offset = value - m_base;
+	if(offset < std::numeric_limits< qint32 >::min() || offset > std::numeric_limits< qint32 >::max()){
+		/// too far from the first tick: keep all ticks as is
+		m_ticks.reserve(m_offsets.size() + 1);
+		for(int i = 0; i < m_offsets.size(); ++i){
+			m_ticks.push_back(m_base + m_offsets.at(i));
+		}
+		m_ticks.push_back(value);
+		m_offsets.clear();
+		m_far = true;
+		return;
+	}
+	m_offsets.push_back(static_cast< qint32 >(offset));
+}
+
+void TickColumn::append(const TickColumn &other)
+{
+	reserve(size() + other.size());
+	for(int i = 0; i < other.size(); ++i){
+		push_back(other.at(i));
+	}
+}
+
+int TickColumn::size() const
+{
+	return m_far? m_ticks.size() : m_offsets.size();
+}
+
+void TickColumn::reserve(int count)
+{
+	if(m_far)
+		m_ticks.reserve(count);
+	else
+		m_offsets.reserve(count);
+}
+
+void TickColumn::clear()
+{
+	m_offsets.clear();
+	m_ticks.clear();
+	m_base = 0;
+	m_far = false;
+}
+
+size_t TickColumn::bytes() const
+{
+	return m_offsets.bytes() + m_ticks.capacity() * sizeof(qint64);
+}
+
+///////////////////////////////////
+
+TelemetryColumns::TelemetryColumns()
+	: m_size(0)
+{
+
+}
+
+void TelemetryColumns::push_back(const StructTelemetry &st)
+{
+	m_bank.push_back(st.bank);
+	m_course.push_back(st.course);
+	m_tangaj.push_back(st.tangaj);
+	m_height.push_back(st.height);
+	m_gyro_temp.push_back(st.gyroscope.temp);
+
+	for(int i = 0; i < 3; ++i){
+		m_accel[i].push_back(st.gyroscope.accel.data[i]);
+		m_gyro[i].push_back(st.gyroscope.gyro.data[i]);
+		m_compass[i].push_back(st.compass.data.data[i]);
+	}
+	m_afs_sel.push_back(st.gyroscope.afs_sel);
+	m_fs_sel.push_back(st.gyroscope.fs_sel);
+	m_freq.push_back(st.gyroscope.freq);
+	m_gyro_tick.push_back(st.gyroscope.tick);
+
+	m_compass_tick.push_back(st.compass.tick);
+
+	m_baro_data.push_back(st.barometer.data);
+	m_baro_temp.push_back(st.barometer.temp);
+	m_baro_tick.push_back(st.barometer.tick);
+
+	m_size++;
+}
+
+void TelemetryColumns::append(const TelemetryColumns &other)
+{
+	if(&other == this){
+		TelemetryColumns copy(other);
+		append(copy);
+		return;
+	}
+	m_bank += other.m_bank;
+	m_course += other.m_course;
+	m_tangaj += other.m_tangaj;
+	m_height += other.m_height;
+	m_gyro_temp += other.m_gyro_temp;
+
+	for(int i = 0; i < 3; ++i){
+		m_accel[i].append(other.m_accel[i]);
+		m_gyro[i].append(other.m_gyro[i]);
+		m_compass[i].append(other.m_compass[i]);
+	}
+	m_afs_sel.append(other.m_afs_sel);
+	m_fs_sel.append(other.m_fs_sel);
+	m_freq.append(other.m_freq);
+	m_gyro_tick.append(other.m_gyro_tick);
+	m_compass_tick.append(other.m_compass_tick);
+
+	m_baro_data.append(other.m_baro_data);
+	m_baro_temp.append(other.m_baro_temp);
+	m_baro_tick.append(other.m_baro_tick);
+
+	m_size += other.m_size;
+}
+
+void TelemetryColumns::append(const QVector<StructTelemetry> &data)
+{
+	reserve(m_size + data.size());
+	foreach (const StructTelemetry& st, data) {
+		push_back(st);
+	}
+}
+
+TelemetryColumns &TelemetryColumns::operator+=(const TelemetryColumns &other)
+{
+	append(other);
+	return *this;
+}
+
+StructTelemetry TelemetryColumns::at(int index) const
+{
+	StructTelemetry st;
+
+	st.bank = m_bank[index];
+	st.course = m_course[index];
+	st.tangaj = m_tangaj[index];
+	st.height = m_height[index];
+	st.gyroscope.temp = m_gyro_temp[index];
+
+	st.gyroscope.accel = accel(index);
+	st.gyroscope.gyro = gyro(index);
+	st.gyroscope.afs_sel = m_afs_sel.at(index);
+	st.gyroscope.fs_sel = m_fs_sel.at(index);
+	st.gyroscope.freq = m_freq.at(index);
+	st.gyroscope.tick = m_gyro_tick.at(index);
+
+	st.compass.data = compass(index);
+	st.compass.tick = m_compass_tick.at(index);
+
+	st.barometer.data = m_baro_data.at(index);
+	st.barometer.temp = m_baro_temp.at(index);
+	st.barometer.tick = m_baro_tick.at(index);
+
+	return st;
+}
+
+QVector<Vector3d> TelemetryColumns::accel_vectors() const
+{
+	QVector< Vector3d > res;
+	res.reserve(m_size);
+	for(int i = 0; i < m_size; ++i){
+		res.push_back(accel(i));
+	}
+	return res;
+}
+
+QVector<Vector3d> TelemetryColumns::gyro_vectors() const
+{
+	QVector< Vector3d > res;
+	res.reserve(m_size);
+	for(int i = 0; i < m_size; ++i){
+		res.push_back(gyro(i));
+	}
+	return res;
+}
+
+QVector<Vector3d> TelemetryColumns::compass_vectors() const
+{
+	QVector< Vector3d > res;
+	res.reserve(m_size);
+	for(int i = 0; i < m_size; ++i){
+		res.push_back(compass(i));
+	}
+	return res;
+}
+
+int TelemetryColumns::size() const
+{
+	return m_size;
+}
+
+bool TelemetryColumns::empty() const
+{
+	return m_size == 0;
+}
+
+void TelemetryColumns::reserve(int count)
+{
+	m_bank.reserve(count);
+	m_course.reserve(count);
+	m_tangaj.reserve(count);
+	m_height.reserve(count);
+	m_gyro_temp.reserve(count);
+
+	for(int i = 0; i < 3; ++i){
+		m_accel[i].reserve(count);
+		m_gyro[i].reserve(count);
+		m_compass[i].reserve(count);
+	}
+	m_afs_sel.reserve(count);
+	m_fs_sel.reserve(count);
+	m_freq.reserve(count);
+	m_gyro_tick.reserve(count);
+	m_compass_tick.reserve(count);
+
+	m_baro_data.reserve(count);
+	m_baro_temp.reserve(count);
+	m_baro_tick.reserve(count);
+}
+
+void TelemetryColumns::clear()
+{
+	m_bank.clear();
+	m_course.clear();
+	m_tangaj.clear();
+	m_height.clear();
+	m_gyro_temp.clear();
+
+	for(int i = 0; i < 3; ++i){
+		m_accel[i].clear();
+		m_gyro[i].clear();
+		m_compass[i].clear();
+	}
+	m_afs_sel.clear();
+	m_fs_sel.clear();
+	m_freq.clear();
+	m_gyro_tick.clear();
+	m_compass_tick.clear();
+
+	m_baro_data.clear();
+	m_baro_temp.clear();
+	m_baro_tick.clear();
+
+	m_size = 0;
+}
+
+size_t TelemetryColumns::bytes() const
+{
+	size_t res = (m_bank.capacity() + m_course.capacity() + m_tangaj.capacity()
+				  + m_height.capacity() + m_gyro_temp.capacity()) * sizeof(float);
+
+	for(int i = 0; i < 3; ++i){
+		res += m_accel[i].bytes() + m_gyro[i].bytes() + m_compass[i].bytes();
+	}
+	res += m_afs_sel.bytes() + m_fs_sel.bytes() + m_freq.bytes();
+	res += m_gyro_tick.bytes() + m_compass_tick.bytes();
+	res += m_baro_data.bytes() + m_baro_temp.bytes() + m_baro_tick.bytes();
+	return res;
+}
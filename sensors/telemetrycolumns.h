@@ -0,0 +1,142 @@
+#ifndef TELEMETRYCOLUMNS_H
+#define TELEMETRYCOLUMNS_H
+
+#include <QVector>
+
+#include <struct_controls.h>
+
+/**
+ * @brief The PackedColumn class
+ * column of integers in int16 while all values fit to it, after that in int32
+ */
+class PackedColumn
+{
+public:
+	PackedColumn();
+
+	void push_back(qint32 value);
+	void append(const PackedColumn& other);
+	inline qint32 at(int index) const{
+		return m_wide? m_data32[index] : m_data16[index];
+	}
+	int size() const;
+	void reserve(int count);
+	void clear();
+	bool is_wide() const;
+	/**
+	 * @brief bytes
+	 * @return memory of values
+	 */
+	size_t bytes() const;
+
+private:
+	bool m_wide;
+	QVector< qint16 > m_data16;
+	QVector< qint32 > m_data32;
+
+	void promote();
+};
+
+/**
+ * @brief The TickColumn class
+ * ticks as offsets from the first tick in the packed column.
+ * if the offset does not fit to int32 ticks are kept as is
+ */
+class TickColumn
+{
+public:
+	TickColumn();
+
+	void push_back(qint64 value);
+	void append(const TickColumn& other);
+	inline qint64 at(int index) const{
+		return m_far? m_ticks[index] : m_base + m_offsets.at(index);
+	}
+	int size() const;
+	void reserve(int count);
+	void clear();
+	size_t bytes() const;
+
+private:
+	qint64 m_base;
+	bool m_far;
+	PackedColumn m_offsets;
+	QVector< qint64 > m_ticks;
+};
+
+/**
+ * @brief The TelemetryColumns class
+ * columnar store of telemetry: each field in own array.
+ * sensors are packed to int16/int32, ticks are offsets from the first tick,
+ * angles and temperature are floats
+ */
+class TelemetryColumns
+{
+public:
+	TelemetryColumns();
+
+	void push_back(const sc::StructTelemetry& st);
+	void append(const TelemetryColumns& other);
+	void append(const QVector< sc::StructTelemetry >& data);
+	TelemetryColumns& operator+= (const TelemetryColumns& other);
+
+	/**
+	 * @brief at
+	 * assemble the full sample
+	 * @param index
+	 * @return
+	 */
+	sc::StructTelemetry at(int index) const;
+
+	inline vector3_::Vector3i accel(int index) const{
+		return vector3_::Vector3i(m_accel[0].at(index), m_accel[1].at(index), m_accel[2].at(index));
+	}
+	inline vector3_::Vector3i gyro(int index) const{
+		return vector3_::Vector3i(m_gyro[0].at(index), m_gyro[1].at(index), m_gyro[2].at(index));
+	}
+	inline vector3_::Vector3i compass(int index) const{
+		return vector3_::Vector3i(m_compass[0].at(index), m_compass[1].at(index), m_compass[2].at(index));
+	}
+	inline qint64 tick(int index) const{
+		return m_gyro_tick.at(index);
+	}
+
+	QVector< vector3_::Vector3d > accel_vectors() const;
+	QVector< vector3_::Vector3d > gyro_vectors() const;
+	QVector< vector3_::Vector3d > compass_vectors() const;
+
+	int size() const;
+	bool empty() const;
+	void reserve(int count);
+	void clear();
+	/**
+	 * @brief bytes
+	 * @return memory of all columns
+	 */
+	size_t bytes() const;
+
+private:
+	int m_size;
+
+	QVector< float > m_bank;
+	QVector< float > m_course;
+	QVector< float > m_tangaj;
+	QVector< float > m_height;
+	QVector< float > m_gyro_temp;
+
+	PackedColumn m_accel[3];
+	PackedColumn m_gyro[3];
+	PackedColumn m_afs_sel;
+	PackedColumn m_fs_sel;
+	PackedColumn m_freq;
+	TickColumn m_gyro_tick;
+
+	PackedColumn m_compass[3];
+	TickColumn m_compass_tick;
+
+	PackedColumn m_baro_data;
+	PackedColumn m_baro_temp;
+	TickColumn m_baro_tick;
+};
+
+#endif // TELEMETRYCOLUMNS_H
@@ -0,0 +1,505 @@
+#include "telemetryloader.h"
+
+#include <QFile>
+#include <QRunnable>
+#include <QByteArray>
+
+#include <functional>
+#include <string.h>
+
+#include "telemetrycompression.h"
+
+using namespace sc;
+using namespace vector3_;
+
+/// size of the part of the csv for one task
+const qint64 csv_part_size = 4 * 1024 * 1024;
+/// count of binary records for one task
+const int binary_part_records = 64 * 1024;
+/// count of compressed blocks for one task
+const int compressed_part_blocks = 16;
+/// maximum count of fields in the line of the csv
+const int max_csv_fields = 32;
+
+/////////////////////////////////
+
+class LoaderRunnable: public QRunnable
+{
+public:
+	explicit LoaderRunnable(const std::function< void() >& func)
+		: m_func(func)
+	{
+	}
+
+	virtual void run(){
+		m_func();
+	}
+
+private:
+	std::function< void() > m_func;
+};
+
+/////////////////////////////////
+
+struct CsvField{
+	CsvField(): d(0), i(0) {}
+
+	double d;
+	qint64 i;
+};
+
+static const double pow10_table[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief parse_field
+ * number in the c locale. exact for mantissas up to 2^53 and exponents up to 22,
+ * other numbers and words as nan go through QByteArray::toDouble
+ * @return false if the field is not a number
+ */
+static bool parse_field(const char* begin, const char* end, CsvField& field)
+{
+	while(begin < end && (*begin == ' ' || *begin == '\t'))
+		begin++;
+	while(end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+		end--;
+	if(begin == end)
+		return false;
+
+	const char* p = begin;
+	bool neg = false;
+	if(*p == '-' || *p == '+'){
+		neg = *p == '-';
+		p++;
+	}
+
+	quint64 mantissa = 0;
+	int digits = 0, exp10 = 0;
+	bool integer = true, has_digits = false;
+
+	while(p < end && *p >= '0' && *p <= '9'){
+		has_digits = true;
+		if(digits < 19){
+			mantissa = mantissa * 10 + (*p - '0');
+			if(mantissa)
+				digits++;
+		}else{
+			exp10++;
+		}
+		p++;
+	}
+	if(p < end && *p == '.'){
+		integer = false;
+		p++;
+		while(p < end && *p >= '0' && *p <= '9'){
+			has_digits = true;
+			if(digits < 19){
+				mantissa = mantissa * 10 + (*p - '0');
+				if(mantissa)
+					digits++;
+				exp10--;
+			}
+			p++;
+		}
+	}
+	if(p < end && (*p == 'e' || *p == 'E')){
+		integer = false;
+		p++;
+		bool eneg = false;
+		if(p < end && (*p == '-' || *p == '+')){
+			eneg = *p == '-';
+			p++;
+		}
+		int e = 0;
+		while(p < end && *p >= '0' && *p <= '9'){
+			e = qMin(e * 10 + (*p - '0'), 10000);
+			p++;
+		}
+		exp10 += eneg? -e : e;
+	}
+
+	if(p != end || !has_digits || (digits >= 19 && integer)){
+		bool ok = false;
+		QByteArray str(begin, end - begin);
+		field.d = str.toDouble(&ok);
+		field.i = integer? str.toLongLong() : (qint64)field.d;
+		return ok;
+	}
+
+	if(mantissa < (1ull << 53) && exp10 >= -22 && exp10 <= 22){
+		double val = (double)mantissa;
+		val = exp10 < 0? val / pow10_table[-exp10] : val * pow10_table[exp10];
+		field.d = neg? -val : val;
+	}else{
+		field.d = QByteArray(begin, end - begin).toDouble();
+	}
+
+	if(integer && exp10 == 0)
+		field.i = neg? -(qint64)mantissa : (qint64)mantissa;
+	else
+		field.i = (qint64)field.d;
+	return true;
+}
+
+bool TelemetryLoader::parse_csv_line(const char *begin, const char *end, StructTelemetry &st)
+{
+	CsvField f[max_csv_fields];
+	int n = 0;
+
+	const char* p = begin;
+	while(p < end && n < max_csv_fields){
+		const char* sep = (const char*)memchr(p, ';', end - p);
+		const char* fend = sep? sep : end;
+		if(!parse_field(p, fend, f[n])){
+			/// the empty field after the last ';'
+			if(!sep && n)
+				break;
+		}
+		n++;
+		if(!sep)
+			break;
+		p = sep + 1;
+	}
+
+	if(n == 7){
+		st.gyroscope.accel = Vector3i(f[0].i, f[1].i, f[2].i);
+		st.gyroscope.temp = f[3].d;
+		st.gyroscope.gyro = Vector3i(f[4].i, f[5].i, f[6].i);
+		st.gyroscope.afs_sel = 0;
+		st.gyroscope.fs_sel = 0;
+		st.gyroscope.freq = 100;
+		st.gyroscope.tick = 0;
+		return true;
+	}
+	if(n < 13)
+		return false;
+
+	st.bank = f[0].d;
+	st.course = f[1].d;
+	st.tangaj = f[2].d;
+	st.height = f[3].d;
+	st.gyroscope.temp = f[4].d;
+	st.gyroscope.accel = Vector3i(f[5].i, f[6].i, f[7].i);
+	st.gyroscope.gyro = Vector3i(f[8].i, f[9].i, f[10].i);
+	st.gyroscope.afs_sel = f[11].i;
+	st.gyroscope.fs_sel = f[12].i;
+	/// fields after 13th are optional
+	st.gyroscope.freq = n > 13? f[13].i : 100;
+	st.gyroscope.tick = n > 14? f[14].i : 0;
+
+	if(n >= 22){
+		st.compass.data = Vector3i(f[15].i, f[16].i, f[17].i);
+		st.compass.tick = f[18].i;
+		st.barometer.data = f[19].i;
+		st.barometer.temp = f[20].i;
+		st.barometer.tick = f[21].i;
+	}
+	return true;
+}
+
+/////////////////////////////////
+
+TelemetryLoader::TelemetryLoader()
+	: m_format(TelemetryFormat::CSV)
+	, m_parsed(0)
+	, m_total(0)
+	, m_cancel(false)
+	, m_broken(false)
+{
+}
+
+TelemetryLoader::~TelemetryLoader()
+{
+	cancel();
+	m_pool.waitForDone();
+}
+
+TelemetryFormat::Format TelemetryLoader::format() const
+{
+	return m_format;
+}
+
+QString TelemetryLoader::error() const
+{
+	return m_error;
+}
+
+double TelemetryLoader::progress() const
+{
+	qint64 total = m_total;
+	return total? (double)m_parsed / total : 0;
+}
+
+void TelemetryLoader::cancel()
+{
+	m_cancel = true;
+}
+
+bool TelemetryLoader::is_cancelled() const
+{
+	return m_cancel;
+}
+
+bool TelemetryLoader::load(const QString &fileName, QVector<StructTelemetry> &dst)
+{
+	return load_parts< QVector< StructTelemetry > >(fileName, dst);
+}
+
+bool TelemetryLoader::load(const QString &fileName, TelemetryColumns &dst)
+{
+	return load_parts< TelemetryColumns >(fileName, dst);
+}
+
+bool TelemetryLoader::load(const QString &fileName, const PartReceiver &receiver)
+{
+	return load_parts< TelemetryColumns >(fileName, receiver);
+}
+
+/**
+ * @brief append_part
+ * concatenation of the parsed part and release of its memory
+ */
+static void append_part(QVector< StructTelemetry >& dst, QVector< StructTelemetry >& part)
+{
+	dst += part;
+	part = QVector< StructTelemetry >();
+}
+
+static void append_part(TelemetryColumns& dst, TelemetryColumns& part)
+{
+	dst.append(part);
+	part = TelemetryColumns();
+}
+
+static void append_part(const TelemetryLoader::PartReceiver& receiver, TelemetryColumns& part)
+{
+	receiver(part);
+	part = TelemetryColumns();
+}
+
+void TelemetryLoader::start_part(int index, const std::function<void ()> &func)
+{
+	m_pool.start(new LoaderRunnable([this, index, func](){
+		func();
+
+		QMutexLocker lock(&m_parts_lock);
+		m_finished[index] = true;
+		m_part_finished.wakeAll();
+	}));
+}
+
+/**
+ * @brief TelemetryLoader::collect_parts
+ * parts are given to the sink in order, each one as soon as it and all previous are parsed
+ */
+template< class Container, class Sink >
+void TelemetryLoader::collect_parts(QVector< Container > &parts, Sink &sink)
+{
+	for(int i = 0; i < parts.size(); i++){
+		{
+			QMutexLocker lock(&m_parts_lock);
+			while(!m_finished[i])
+				m_part_finished.wait(&m_parts_lock);
+		}
+		if(m_cancel || m_broken)
+			continue;
+		append_part(sink, parts[i]);
+	}
+	m_pool.waitForDone();
+}
+
+template< class Container, class Sink >
+bool TelemetryLoader::load_parts(const QString &fileName, Sink &sink)
+{
+	m_error.clear();
+	m_cancel = false;
+	m_broken = false;
+	m_parsed = 0;
+	m_total = 0;
+
+	QFile file(fileName);
+	if(!file.open(QIODevice::ReadOnly)){
+		m_error = file.errorString();
+		return false;
+	}
+
+	const qint64 size = file.size();
+	if(!size)
+		return true;
+
+	/// the copy only if the file can not be mapped
+	QByteArray copy;
+	const char* data = (const char*)file.map(0, size);
+	if(!data){
+		copy = file.readAll();
+		data = copy.constData();
+	}
+	m_total = size;
+
+	TelemetrySchema schema;
+	int codec = 0;
+	const int head_size = (int)qMin< qint64 >(size, 64 * 1024);
+	QVector< Container > parts;
+	bool res;
+
+	int header_size = TelemetryFormat::read_header(data, head_size, schema);
+	if(header_size && schema.is_valid()){
+		m_format = TelemetryFormat::Binary;
+		res = load_binary(data, size, header_size, schema, parts, sink);
+	}else if((header_size = TelemetryCompression::read_header(data, head_size, schema, codec)) && schema.is_valid()){
+		m_format = TelemetryFormat::Compressed;
+		if(!TelemetryCompression::is_codec_supported(codec)){
+			m_error = "codec " + QString::number(codec) + " of the compressed log is not supported";
+			return false;
+		}
+		res = load_compressed(data, size, header_size, schema, codec, parts, sink);
+	}else{
+		m_format = TelemetryFormat::CSV;
+		res = load_csv(data, size, parts, sink);
+	}
+
+	if(m_cancel){
+		m_error = "cancelled";
+		return false;
+	}
+	return res;
+}
+
+template< class Container, class Sink >
+bool TelemetryLoader::load_csv(const char *data, qint64 size, QVector< Container > &parts, Sink &sink)
+{
+	/// parts are aligned to lines
+	QVector< qint64 > bounds;
+	bounds.push_back(0);
+	qint64 pos = 0;
+	while(pos < size){
+		qint64 next = qMin(size, pos + csv_part_size);
+		if(next < size){
+			const char* nl = (const char*)memchr(data + next, '\n', size - next);
+			next = nl? nl - data + 1 : size;
+		}
+		bounds.push_back(next);
+		pos = next;
+	}
+
+	parts.resize(bounds.size() - 1);
+	m_finished = QVector< bool >(parts.size(), false);
+
+	for(int i = 0; i < parts.size(); i++){
+		const char* begin = data + bounds[i];
+		const char* end = data + bounds[i + 1];
+		Container* out = &parts[i];
+
+		start_part(i, [this, begin, end, out](){
+			/// rough count of lines for the reserve
+			out->reserve((end - begin) / 64);
+			const char* p = begin;
+			int lines = 0;
+			while(p < end){
+				const char* nl = (const char*)memchr(p, '\n', end - p);
+				const char* line_end = nl? nl : end;
+				StructTelemetry st;
+				if(parse_csv_line(p, line_end, st))
+					out->push_back(st);
+				p = line_end + 1;
+				if(++lines % 4096 == 0 && m_cancel)
+					return;
+			}
+			m_parsed += end - begin;
+		});
+	}
+	collect_parts(parts, sink);
+	return true;
+}
+
+template< class Container, class Sink >
+bool TelemetryLoader::load_binary(const char *data, qint64 size, int header_size, const TelemetrySchema &schema,
+								  QVector< Container > &parts, Sink &sink)
+{
+	const qint64 count = (size - header_size) / schema.record_size;
+	const uchar* records = (const uchar*)data + header_size;
+
+	parts.resize((count + binary_part_records - 1) / binary_part_records);
+	m_finished = QVector< bool >(parts.size(), false);
+
+	/// each task fills own part
+	for(int p = 0; p < parts.size(); p++){
+		const qint64 i = (qint64)p * binary_part_records;
+		const qint64 last = qMin(count, i + binary_part_records);
+		Container* out = &parts[p];
+
+		start_part(p, [this, records, out, i, last, &schema](){
+			if(m_cancel)
+				return;
+			out->reserve(last - i);
+			StructTelemetry st;
+			for(qint64 j = i; j < last; j++){
+				TelemetryFormat::decode(records + j * schema.record_size, schema, st);
+				out->push_back(st);
+			}
+			m_parsed += (last - i) * schema.record_size;
+		});
+	}
+	collect_parts(parts, sink);
+	return true;
+}
+
+template< class Container, class Sink >
+bool TelemetryLoader::load_compressed(const char *data, qint64 size, int header_size, const TelemetrySchema &schema,
+									  int codec, QVector< Container > &parts, Sink &sink)
+{
+	/// offsets of blocks and count of their samples
+	struct Block{
+		qint64 offset;
+		TelemetryBlockHeader header;
+	};
+	QVector< Block > blocks;
+
+	qint64 pos = header_size;
+	Block block;
+	while(TelemetryCompression::read_block_header(data + pos, qMin< qint64 >(size - pos, TelemetryCompression::block_header_size), block.header)){
+		if(pos + TelemetryCompression::block_header_size + block.header.size > size)
+			break;
+		block.offset = pos + TelemetryCompression::block_header_size;
+		blocks.push_back(block);
+		pos = block.offset + block.header.size;
+	}
+
+	parts.resize((blocks.size() + compressed_part_blocks - 1) / compressed_part_blocks);
+	m_finished = QVector< bool >(parts.size(), false);
+
+	for(int p = 0; p < parts.size(); p++){
+		const int i = p * compressed_part_blocks;
+		const int last = qMin(blocks.size(), i + compressed_part_blocks);
+		Container* out = &parts[p];
+
+		start_part(p, [this, data, out, &blocks, &schema, codec, i, last](){
+			QByteArray records;
+			StructTelemetry st;
+			for(int b = i; b < last && !m_cancel; b++){
+				const Block& block = blocks[b];
+				records.resize(0);
+				if(!TelemetryCompression::decode_block(data + block.offset, block.header, schema, codec, records)){
+					m_broken = true;
+					return;
+				}
+				out->reserve(out->size() + block.header.count);
+				const uchar* rec = (const uchar*)records.constData();
+				for(quint32 j = 0; j < block.header.count; j++, rec += schema.record_size){
+					TelemetryFormat::decode(rec, schema, st);
+					out->push_back(st);
+				}
+				m_parsed += TelemetryCompression::block_header_size + block.header.size;
+			}
+		});
+	}
+	collect_parts(parts, sink);
+
+	if(m_broken){
+		m_error = "broken block of the compressed log";
+		return false;
+	}
+	return true;
+}
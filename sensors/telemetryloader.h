@@ -0,0 +1,124 @@
+#ifndef TELEMETRYLOADER_H
+#define TELEMETRYLOADER_H
+
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+
+#include <struct_controls.h>
+
+#include "telemetryformat.h"
+#include "telemetrycolumns.h"
+
+/**
+ * @brief The TelemetryLoader class
+ * loader of logs of telemetry: csv, binary and compressed.
+ * the file is mapped to memory and split to parts parsed in the private pool:
+ * csv by lines, binary by records, compressed by blocks. each part is filled by own task
+ * and parts are concatenated in order as soon as they are parsed
+ */
+class TelemetryLoader
+{
+public:
+	/**
+	 * @brief PartReceiver
+	 * receiver of parsed parts in order of the file. it is called in the thread of load()
+	 * and may take the data of the part
+	 */
+	typedef std::function< void(TelemetryColumns& part) > PartReceiver;
+
+	TelemetryLoader();
+	~TelemetryLoader();
+
+	/**
+	 * @brief load
+	 * @param fileName
+	 * @param dst - loaded telemetry
+	 * @return false if the file can not be read or is broken
+	 */
+	bool load(const QString& fileName, QVector< sc::StructTelemetry >& dst);
+	/**
+	 * @brief load
+	 * parts are converted to columns in the tasks
+	 * @param fileName
+	 * @param dst - loaded telemetry
+	 * @return
+	 */
+	bool load(const QString& fileName, TelemetryColumns& dst);
+	/**
+	 * @brief load
+	 * progressive load: parts are not accumulated, each one is given to the receiver
+	 * while next parts are parsed
+	 * @param fileName
+	 * @param receiver
+	 * @return
+	 */
+	bool load(const QString& fileName, const PartReceiver& receiver);
+	/**
+	 * @brief format
+	 * format of the last loaded file
+	 * @return
+	 */
+	TelemetryFormat::Format format() const;
+	QString error() const;
+	/**
+	 * @brief progress
+	 * part of the parsed data [0, 1]. can be read from any thread
+	 * @return
+	 */
+	double progress() const;
+	/**
+	 * @brief cancel
+	 * stop the current load from any thread
+	 */
+	void cancel();
+	bool is_cancelled() const;
+
+	/**
+	 * @brief parse_csv_line
+	 * parse one line with 7, 13, 14, 15 or 22 fields separated by ';'
+	 * @param begin
+	 * @param end - end of line without '\n'
+	 * @param st
+	 * @return false if the line is empty or has unknown count of fields
+	 */
+	static bool parse_csv_line(const char* begin, const char* end, sc::StructTelemetry& st);
+
+private:
+	Q_DISABLE_COPY(TelemetryLoader)
+
+	QThreadPool m_pool;
+	TelemetryFormat::Format m_format;
+	QString m_error;
+	std::atomic< qint64 > m_parsed;
+	std::atomic< qint64 > m_total;
+	std::atomic< bool > m_cancel;
+	std::atomic< bool > m_broken;
+
+	/// parts finished by tasks
+	QMutex m_parts_lock;
+	QWaitCondition m_part_finished;
+	QVector< bool > m_finished;
+
+	void start_part(int index, const std::function< void() >& func);
+	template< class Container, class Sink >
+	void collect_parts(QVector< Container >& parts, Sink& sink);
+
+	template< class Container, class Sink >
+	bool load_parts(const QString& fileName, Sink& sink);
+	template< class Container, class Sink >
+	bool load_csv(const char* data, qint64 size, QVector< Container >& parts, Sink& sink);
+	template< class Container, class Sink >
+	bool load_binary(const char* data, qint64 size, int header_size, const TelemetrySchema& schema,
+					 QVector< Container >& parts, Sink& sink);
+	template< class Container, class Sink >
+	bool load_compressed(const char* data, qint64 size, int header_size, const TelemetrySchema& schema,
+						 int codec, QVector< Container >& parts, Sink& sink);
+};
+
+#endif // TELEMETRYLOADER_H
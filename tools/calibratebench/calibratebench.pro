@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# benchmark and accuracy of calibrations on synthetic data
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = calibratebench
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += _USE_MATH_DEFINES
+
+ROOT_DIR = $$PWD/../..
+
+INCLUDEPATH += $$ROOT_DIR/sensors
+
+SOURCES += main.cpp \
+			$$ROOT_DIR/sensors/calibrateaccelerometer.cpp \
+			$$ROOT_DIR/sensors/calibrationjob.cpp \
+			$$ROOT_DIR/sensors/spheregriddecimator.cpp
+
+HEADERS += $$ROOT_DIR/sensors/calibrateaccelerometer.h \
+			$$ROOT_DIR/sensors/calibrationjob.h \
+			$$ROOT_DIR/sensors/spheregriddecimator.h
+
+include($$ROOT_DIR/submodules/struct_controls/struct_controls.pri)
@@ -0,0 +1,342 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+
+#include <random>
+
+#include "calibrateaccelerometer.h"
+#include "calibrationjob.h"
+#include "spheregriddecimator.h"
+
+using namespace vector3_;
+
+/**
+ * @brief The BenchParams struct
+ * parameters of the synthetic data set
+ */
+struct BenchParams{
+	BenchParams()
+		: radius(16384)
+		, noise(50)
+		, outliers(0)
+		, coverage(1)
+		, axes(1, 1, 1)
+		, center(300, -200, 500)
+		, seed(1)
+		, max_pass(100)
+		, repeat(1)
+		, csv(false)
+	{
+		sizes << 1000 << 10000 << 100000;
+	}
+
+	QVector< int > sizes;
+	double radius;
+	double noise;
+	double outliers;
+	double coverage;
+	Vector3d axes;
+	Vector3d center;
+	unsigned seed;
+	int max_pass;
+	int repeat;
+	bool csv;
+	QString output;
+};
+
+/**
+ * @brief The BenchResult struct
+ * one line of the report
+ */
+struct BenchResult{
+	BenchResult(): n(0), n_used(0), time_ms(0), passes(0), center_error(0), radius_error(0), deviation(0) {}
+
+	QString algorithm;
+	int n;
+	int n_used;
+	double time_ms;
+	int passes;
+	double center_error;
+	double radius_error;
+	double deviation;
+};
+
+/////////////////////////////////
+
+#if QT_VERSION >= 0x050000
+static void silent_handler(QtMsgType type, const QMessageLogContext&, const QString& msg)
+{
+	if(type != QtDebugMsg)
+		fprintf(stderr, "%s\n", msg.toLocal8Bit().constData());
+}
+#else
+static void silent_handler(QtMsgType type, const char* msg)
+{
+	if(type != QtDebugMsg)
+		fprintf(stderr, "%s\n", msg);
+}
+#endif
+
+static void usage()
+{
+	QTextStream out(stderr);
+	out << "calibratebench [options]\n"
+		   "  --sizes n1,n2,...     count of samples (default 1000,10000,100000; up to 10000000)\n"
+		   "  --radius r            radius of the sphere (default 16384)\n"
+		   "  --axes a,b,c          relative lengths of the ellipsoid axes (default 1,1,1)\n"
+		   "  --center x,y,z        center of the sphere (default 300,-200,500)\n"
+		   "  --noise sigma         gaussian noise of each axis (default 50)\n"
+		   "  --outliers part       part of the samples replaced by outliers [0, 1] (default 0)\n"
+		   "  --coverage part       part of the sphere covered by orientations, cap from the top [0, 1] (default 1)\n"
+		   "  --seed value          seed of the generator (default 1)\n"
+		   "  --max-pass value      maximum passes of the grid search (default 100)\n"
+		   "  --repeat value        repeats of each measurement (default 1)\n"
+		   "  --csv                 csv instead of json lines\n"
+		   "  --output file         write the report to the file instead of stdout\n";
+}
+
+static Vector3d parse_vector(const QString& str, const Vector3d& def)
+{
+	QStringList sl = str.split(',');
+	if(sl.size() != 3)
+		return def;
+	return Vector3d(sl[0].toDouble(), sl[1].toDouble(), sl[2].toDouble());
+}
+
+static bool parse_args(const QStringList& args, BenchParams& params)
+{
+	for(int i = 1; i < args.size(); i++){
+		QString arg = args[i];
+		QString val = i + 1 < args.size()? args[i + 1] : QString();
+
+		if(arg == "--csv"){
+			params.csv = true;
+			continue;
+		}
+		if(arg == "--help" || arg == "-h" || val.isEmpty()){
+			return false;
+		}
+		i++;
+
+		if(arg == "--sizes"){
+			params.sizes.clear();
+			foreach (QString s, val.split(',')) {
+				params.sizes.push_back(s.toInt());
+			}
+		}else if(arg == "--radius"){
+			params.radius = val.toDouble();
+		}else if(arg == "--axes"){
+			params.axes = parse_vector(val, params.axes);
+		}else if(arg == "--center"){
+			params.center = parse_vector(val, params.center);
+		}else if(arg == "--noise"){
+			params.noise = val.toDouble();
+		}else if(arg == "--outliers"){
+			params.outliers = qBound(0., val.toDouble(), 1.);
+		}else if(arg == "--coverage"){
+			params.coverage = qBound(0.01, val.toDouble(), 1.);
+		}else if(arg == "--seed"){
+			params.seed = val.toUInt();
+		}else if(arg == "--max-pass"){
+			params.max_pass = val.toInt();
+		}else if(arg == "--repeat"){
+			params.repeat = qMax(1, val.toInt());
+		}else if(arg == "--output"){
+			params.output = val;
+		}else{
+			return false;
+		}
+	}
+	return true;
+}
+
+/////////////////////////////////
+
+/**
+ * @brief generate_sphere
+ * points on the ellipsoid with noise and outliers. directions cover a cap of the sphere
+ */
+static QVector< Vector3d > generate_sphere(const BenchParams& params, int count, std::mt19937& gen)
+{
+	std::uniform_real_distribution< double > uni(0., 1.);
+	std::normal_distribution< double > noise(0., params.noise > 0? params.noise : 1.);
+
+	const double zmin = 1. - 2. * params.coverage;
+
+	QVector< Vector3d > res;
+	res.reserve(count);
+
+	for(int i = 0; i < count; i++){
+		Vector3d v;
+		if(uni(gen) < params.outliers){
+			v = Vector3d(uni(gen) * 2 - 1, uni(gen) * 2 - 1, uni(gen) * 2 - 1) * (2 * params.radius);
+		}else{
+			double z = zmin + (1. - zmin) * uni(gen);
+			double a = 2 * M_PI * uni(gen);
+			double rxy = sqrt(qMax(0., 1. - z * z));
+			v = Vector3d(rxy * cos(a) * params.axes.x(), rxy * sin(a) * params.axes.y(), z * params.axes.z());
+			v *= params.radius;
+			if(params.noise > 0)
+				v += Vector3d(noise(gen), noise(gen), noise(gen));
+		}
+		res.push_back(v + params.center);
+	}
+	return res;
+}
+
+static QVector< Vector3d > generate_gyro(const BenchParams& params, int count, const Vector3d& bias, std::mt19937& gen)
+{
+	std::normal_distribution< double > noise(0., params.noise > 0? params.noise : 1.);
+
+	QVector< Vector3d > res;
+	res.reserve(count);
+	for(int i = 0; i < count; i++){
+		res.push_back(bias + Vector3d(noise(gen), noise(gen), noise(gen)));
+	}
+	return res;
+}
+
+/////////////////////////////////
+
+static BenchResult run_grid(const QString& name, const QVector< Vector3d >& data, int n, const BenchParams& params)
+{
+	BenchResult res;
+	res.algorithm = name;
+	res.n = n;
+	res.n_used = data.size();
+
+	double time = 0;
+	for(int r = 0; r < params.repeat; r++){
+		CalibrateAccelerometer calibrate;
+		calibrate.set_parameters(data, params.max_pass);
+
+		QElapsedTimer timer;
+		timer.start();
+		calibrate.evaluate();
+		time += timer.nsecsElapsed() / 1e6;
+
+		StructMeanSphere sp = calibrate.result();
+		res.passes = calibrate.pass();
+		res.center_error = (sp.cp - params.center).length();
+		res.radius_error = sp.mean_radius - params.radius;
+		res.deviation = sp.deviation;
+	}
+	res.time_ms = time / params.repeat;
+	return res;
+}
+
+static BenchResult run_grid_decimated(const QVector< Vector3d >& data, const BenchParams& params)
+{
+	QElapsedTimer timer;
+	timer.start();
+	SphereGridDecimator decimator;
+	QVector< Vector3d > dec = decimator.decimate(data);
+	double time_dec = timer.nsecsElapsed() / 1e6;
+
+	BenchResult res = run_grid("grid_decimated", dec, data.size(), params);
+	res.time_ms += time_dec;
+	return res;
+}
+
+static BenchResult run_gyro_bias(int n, const BenchParams& params, std::mt19937& gen)
+{
+	const Vector3d bias(-35, 12, 7);
+	QVector< Vector3d > data = generate_gyro(params, n, bias, gen);
+
+	BenchResult res;
+	res.algorithm = "gyro_bias";
+	res.n = res.n_used = n;
+
+	double time = 0;
+	for(int r = 0; r < params.repeat; r++){
+		GyroBiasJob job(0, data);
+
+		QElapsedTimer timer;
+		timer.start();
+		job.run();
+		time += timer.nsecsElapsed() / 1e6;
+
+		StructMeanSphere sp = job.result();
+		res.center_error = (sp.cp - bias).length();
+		res.deviation = sp.deviation;
+	}
+	res.time_ms = time / params.repeat;
+	return res;
+}
+
+/////////////////////////////////
+
+static void write_result(QTextStream& out, const BenchResult& res, const BenchParams& params)
+{
+	if(params.csv){
+		out << res.algorithm << ";" << res.n << ";" << res.n_used << ";"
+			<< params.noise << ";" << params.outliers << ";" << params.coverage << ";"
+			<< res.time_ms << ";" << res.passes << ";"
+			<< res.center_error << ";" << res.radius_error << ";" << res.deviation << "\n";
+	}else{
+		out << "{\"algorithm\":\"" << res.algorithm << "\""
+			<< ",\"n\":" << res.n
+			<< ",\"n_used\":" << res.n_used
+			<< ",\"noise\":" << params.noise
+			<< ",\"outliers\":" << params.outliers
+			<< ",\"coverage\":" << params.coverage
+			<< ",\"time_ms\":" << res.time_ms
+			<< ",\"passes\":" << res.passes
+			<< ",\"center_error\":" << res.center_error
+			<< ",\"radius_error\":" << res.radius_error
+			<< ",\"deviation\":" << res.deviation
+			<< "}\n";
+	}
+	out.flush();
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	BenchParams params;
+	if(!parse_args(a.arguments(), params)){
+		usage();
+		return 1;
+	}
+
+#if QT_VERSION >= 0x050000
+	qInstallMessageHandler(silent_handler);
+#else
+	qInstallMsgHandler(silent_handler);
+#endif
+
+	QFile file;
+	if(params.output.isEmpty()){
+		file.open(stdout, QIODevice::WriteOnly);
+	}else{
+		file.setFileName(params.output);
+		if(!file.open(QIODevice::WriteOnly)){
+			fprintf(stderr, "can not open %s\n", params.output.toLocal8Bit().constData());
+			return 2;
+		}
+	}
+	QTextStream out(&file);
+	out.setRealNumberPrecision(9);
+
+	if(params.csv){
+		out << "algorithm;n;n_used;noise;outliers;coverage;time_ms;passes;center_error;radius_error;deviation\n";
+	}
+
+	std::mt19937 gen(params.seed);
+
+	foreach (int n, params.sizes) {
+		if(n <= 0)
+			continue;
+
+		QVector< Vector3d > data = generate_sphere(params, n, gen);
+
+		write_result(out, run_grid("grid", data, n, params), params);
+		write_result(out, run_grid_decimated(data, params), params);
+		write_result(out, run_gyro_bias(n, params, gen), params);
+	}
+
+	return 0;
+}
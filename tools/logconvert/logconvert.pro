@@ -0,0 +1,40 @@
+#-------------------------------------------------
+#
+# conversion of logs of telemetry between csv, binary and compressed formats
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = logconvert
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+ROOT_DIR = $$PWD/../..
+
+INCLUDEPATH += $$ROOT_DIR/log \
+			$$ROOT_DIR/sensors
+
+SOURCES += main.cpp \
+			$$ROOT_DIR/log/telemetryformat.cpp \
+			$$ROOT_DIR/log/telemetrycompression.cpp \
+			$$ROOT_DIR/sensors/telemetrycolumns.cpp \
+			$$ROOT_DIR/sensors/telemetryloader.cpp
+
+HEADERS += $$ROOT_DIR/log/telemetryformat.h \
+			$$ROOT_DIR/log/telemetrycompression.h \
+			$$ROOT_DIR/sensors/telemetrycolumns.h \
+			$$ROOT_DIR/sensors/telemetryloader.h
+
+unix{
+	CONFIG += link_pkgconfig
+	packagesExist(liblz4){
+		PKGCONFIG += liblz4
+		DEFINES += HAVE_LZ4
+	}
+}
+
+include($$ROOT_DIR/submodules/struct_controls/struct_controls.pri)
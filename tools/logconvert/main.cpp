@@ -0,0 +1,367 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+
+#include <atomic>
+#include <functional>
+#include <math.h>
+
+#include "telemetryformat.h"
+#include "telemetrycompression.h"
+#include "telemetryloader.h"
+
+using namespace sc;
+
+/// count of samples encoded by one task
+const int part_samples = 64 * 1024;
+
+/**
+ * @brief The ConvertParams struct
+ * options of the command line
+ */
+struct ConvertParams{
+	ConvertParams()
+		: format(TelemetryFormat::Compressed)
+		, codec(TelemetryCompression::default_codec())
+		, verify(false)
+		, threads(QThread::idealThreadCount())
+	{
+	}
+
+	TelemetryFormat::Format format;
+	TelemetryCompression::Codec codec;
+	bool verify;
+	int threads;
+	QString out_dir;
+	QStringList inputs;
+};
+
+class TaskRunnable: public QRunnable
+{
+public:
+	explicit TaskRunnable(const std::function< void() >& func)
+		: m_func(func)
+	{
+	}
+
+	virtual void run(){
+		m_func();
+	}
+
+private:
+	std::function< void() > m_func;
+};
+
+/////////////////////////////////
+
+static void usage()
+{
+	QTextStream out(stderr);
+	out << "logconvert [options] <log|dir>...\n"
+		   "  --to format           csv, binary or compressed (default compressed)\n"
+		   "  --codec name          zlib or lz4 for the compressed format (default lz4 if available)\n"
+		   "  --out-dir dir         directory of converted logs (default the directory of the input)\n"
+		   "  --threads value       count of threads for parsing and encoding (default count of cores)\n"
+		   "  --verify              read the converted log back and compare with the input\n"
+		   "csv logs with 7, 13, 14, 15 and 22 fields are read, csv is written with 22 fields\n";
+}
+
+static bool parse_args(const QStringList& args, ConvertParams& params)
+{
+	for(int i = 1; i < args.size(); i++){
+		QString arg = args[i];
+		QString val = i + 1 < args.size()? args[i + 1] : QString();
+
+		if(arg == "--verify"){
+			params.verify = true;
+			continue;
+		}
+		if(arg == "--help" || arg == "-h"){
+			return false;
+		}
+		if(!arg.startsWith("--")){
+			params.inputs << arg;
+			continue;
+		}
+		if(val.isEmpty()){
+			return false;
+		}
+		i++;
+
+		if(arg == "--to"){
+			if(val == "csv")
+				params.format = TelemetryFormat::CSV;
+			else if(val == "binary")
+				params.format = TelemetryFormat::Binary;
+			else if(val == "compressed")
+				params.format = TelemetryFormat::Compressed;
+			else
+				return false;
+		}else if(arg == "--codec"){
+			if(val == "zlib")
+				params.codec = TelemetryCompression::Zlib;
+			else if(val == "lz4")
+				params.codec = TelemetryCompression::LZ4;
+			else
+				return false;
+		}else if(arg == "--out-dir"){
+			params.out_dir = val;
+		}else if(arg == "--threads"){
+			params.threads = qMax(1, val.toInt());
+		}else{
+			return false;
+		}
+	}
+	return !params.inputs.isEmpty();
+}
+
+static QStringList collect_inputs(const QStringList& inputs)
+{
+	QStringList res;
+	QStringList filters;
+	filters << "*.csv" << "*" + TelemetryFormat::extension(TelemetryFormat::Binary)
+			<< "*" + TelemetryFormat::extension(TelemetryFormat::Compressed);
+
+	foreach (const QString& input, inputs) {
+		if(QFileInfo(input).isDir()){
+			QDir dir(input);
+			foreach (const QString& name, dir.entryList(filters, QDir::Files, QDir::Name)) {
+				res << dir.absoluteFilePath(name);
+			}
+		}else{
+			res << input;
+		}
+	}
+	return res;
+}
+
+/////////////////////////////////
+
+/**
+ * @brief encode_part
+ * samples [begin, end) in the format without the header of the file
+ */
+static void encode_part(const QVector< StructTelemetry >& data, int begin, int end,
+						const ConvertParams& params, QByteArray& out)
+{
+	switch (params.format) {
+	case TelemetryFormat::CSV:
+		out.reserve((end - begin) * 96);
+		for(int i = begin; i < end; i++){
+			TelemetryFormat::encode_csv(data[i], out);
+		}
+		break;
+	case TelemetryFormat::Binary:
+	{
+		const int rs = TelemetryFormat::record_size();
+		out.resize((end - begin) * rs);
+		uchar* dst = (uchar*)out.data();
+		for(int i = begin; i < end; i++, dst += rs){
+			TelemetryFormat::encode(data[i], dst);
+		}
+		break;
+	}
+	case TelemetryFormat::Compressed:
+	{
+		const int rs = TelemetryFormat::record_size();
+		QByteArray raw;
+		for(int i = begin; i < end; i += TelemetryCompression::default_block_records){
+			int count = qMin< int >(TelemetryCompression::default_block_records, end - i);
+			raw.resize(count * rs);
+			uchar* dst = (uchar*)raw.data();
+			for(int j = 0; j < count; j++, dst += rs){
+				TelemetryFormat::encode(data[i + j], dst);
+			}
+			TelemetryCompression::encode_block((const uchar*)raw.constData(), count, params.codec, out);
+		}
+		break;
+	}
+	}
+}
+
+/**
+ * @brief write_log
+ * parts are encoded in the pool by batches and written in order
+ */
+static bool write_log(const QString& fileName, const QVector< StructTelemetry >& data,
+					  const ConvertParams& params, QThreadPool& pool)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	if(params.format == TelemetryFormat::Binary)
+		file.write(TelemetryFormat::header());
+	if(params.format == TelemetryFormat::Compressed)
+		file.write(TelemetryCompression::header(params.codec));
+
+	const int parts = (data.size() + part_samples - 1) / part_samples;
+	const int batch = qMax(1, params.threads * 2);
+
+	QVector< QByteArray > out(batch);
+	for(int first = 0; first < parts; first += batch){
+		int last = qMin(parts, first + batch);
+		for(int p = first; p < last; p++){
+			QByteArray* dst = &out[p - first];
+			dst->resize(0);
+			int begin = p * part_samples;
+			int end = qMin(data.size(), begin + part_samples);
+			pool.start(new TaskRunnable([&data, &params, dst, begin, end](){
+				encode_part(data, begin, end, params, *dst);
+			}));
+		}
+		pool.waitForDone();
+
+		for(int p = first; p < last; p++){
+			if(file.write(out[p - first]) != out[p - first].size())
+				return false;
+		}
+	}
+	return true;
+}
+
+/////////////////////////////////
+
+static bool equal_double(double a, double b, bool csv)
+{
+	if(!csv)
+		return a == b || (a != a && b != b);
+	/// csv keeps 6 significant digits
+	return fabs(a - b) <= 1e-5 * qMax(1., fabs(a));
+}
+
+static bool equal(const StructTelemetry& a, const StructTelemetry& b, bool csv)
+{
+	return equal_double(a.bank, b.bank, csv) && equal_double(a.course, b.course, csv)
+			&& equal_double(a.tangaj, b.tangaj, csv) && equal_double(a.height, b.height, csv)
+			&& equal_double(a.gyroscope.temp, b.gyroscope.temp, csv)
+			&& a.gyroscope.accel.x() == b.gyroscope.accel.x() && a.gyroscope.accel.y() == b.gyroscope.accel.y()
+			&& a.gyroscope.accel.z() == b.gyroscope.accel.z()
+			&& a.gyroscope.gyro.x() == b.gyroscope.gyro.x() && a.gyroscope.gyro.y() == b.gyroscope.gyro.y()
+			&& a.gyroscope.gyro.z() == b.gyroscope.gyro.z()
+			&& a.gyroscope.afs_sel == b.gyroscope.afs_sel && a.gyroscope.fs_sel == b.gyroscope.fs_sel
+			&& a.gyroscope.freq == b.gyroscope.freq && a.gyroscope.tick == b.gyroscope.tick
+			&& a.compass.data.x() == b.compass.data.x() && a.compass.data.y() == b.compass.data.y()
+			&& a.compass.data.z() == b.compass.data.z() && a.compass.tick == b.compass.tick
+			&& a.barometer.data == b.barometer.data && a.barometer.temp == b.barometer.temp
+			&& a.barometer.tick == b.barometer.tick;
+}
+
+/**
+ * @brief verify
+ * @return index of the first different sample or -1
+ */
+static qint64 verify(const QVector< StructTelemetry >& a, const QVector< StructTelemetry >& b,
+					 bool csv, QThreadPool& pool)
+{
+	if(a.size() != b.size())
+		return qMin(a.size(), b.size());
+
+	std::atomic< qint64 > first(-1);
+	for(int begin = 0; begin < a.size(); begin += part_samples){
+		int end = qMin(a.size(), begin + part_samples);
+		pool.start(new TaskRunnable([&a, &b, &first, csv, begin, end](){
+			for(int i = begin; i < end; i++){
+				if(!equal(a[i], b[i], csv)){
+					qint64 cur = first;
+					while((cur < 0 || i < cur) && !first.compare_exchange_weak(cur, i)){
+					}
+					return;
+				}
+			}
+		}));
+	}
+	pool.waitForDone();
+	return first;
+}
+
+/////////////////////////////////
+
+static bool convert(const QString& input, const ConvertParams& params, QThreadPool& pool, QTextStream& log)
+{
+	QFileInfo fi(input);
+	QString dir = params.out_dir.isEmpty()? fi.absolutePath() : params.out_dir;
+	QString output = QDir(dir).absoluteFilePath(fi.completeBaseName() + TelemetryFormat::extension(params.format));
+
+	if(QFileInfo(output).absoluteFilePath() == fi.absoluteFilePath()){
+		log << input << ": the log is already in this format\n";
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	TelemetryLoader loader;
+	QVector< StructTelemetry > data;
+	if(!loader.load(input, data)){
+		log << input << ": " << loader.error() << "\n";
+		return false;
+	}
+	qint64 load_ms = timer.restart();
+
+	if(!write_log(output, data, params, pool)){
+		log << output << ": not written\n";
+		return false;
+	}
+	qint64 write_ms = timer.restart();
+
+	log << input << " -> " << output << "; samples: " << data.size()
+		<< "; size: " << fi.size() << " -> " << QFileInfo(output).size()
+		<< "; read: " << load_ms << " ms; write: " << write_ms << " ms";
+
+	if(params.verify){
+		QVector< StructTelemetry > check;
+		if(!loader.load(output, check)){
+			log << "; verify: " << loader.error() << "\n";
+			return false;
+		}
+		qint64 diff = verify(data, check, params.format == TelemetryFormat::CSV, pool);
+		log << "; read back: " << timer.elapsed() << " ms";
+		if(diff >= 0){
+			log << "; verify: sample " << diff << " differs\n";
+			return false;
+		}
+		log << "; verify: ok";
+	}
+	log << "\n";
+	log.flush();
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	ConvertParams params;
+	if(!parse_args(a.arguments(), params)){
+		usage();
+		return 1;
+	}
+
+	QTextStream log(stderr);
+
+	if(params.format == TelemetryFormat::Compressed && !TelemetryCompression::is_codec_supported(params.codec)){
+		log << "the codec is not supported in this build\n";
+		return 1;
+	}
+	if(!params.out_dir.isEmpty())
+		QDir().mkpath(params.out_dir);
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(params.threads);
+
+	int failed = 0;
+	foreach (const QString& input, collect_inputs(params.inputs)) {
+		if(!convert(input, params, pool, log))
+			failed++;
+	}
+
+	return failed? 2 : 0;
+}